@@ -110,6 +110,34 @@ IEditorHeightmap* C3DEngine::m_pEditorHeightmap = 0;
 extern IParticleManager* CreateParticleManager(bool bEnable);
 extern void              DestroyParticleManager(IParticleManager* pParticleManager);
 
+// Number of jobs rasterizing bands of the wind grid, 0 picks one per worker thread
+static int e_WindGridJobs = 0;
+// Milliseconds per frame octree registration may take before updates are deferred to later frames, 0 = unlimited
+static float e_OctreeUpdateBudget = 0.0f;
+// 1 = display octree registration counts, queue length and time of the last frame
+static int e_OctreeUpdateStats = 0;
+// Scheduled precache points streaming at the same time before further ones wait, points due for arrival are always started
+static int e_PrecacheSchedulerMaxActive = 4;
+// Seconds before their arrival time scheduled precache points may start streaming
+static float e_PrecacheSchedulerLeadTime = 2.0f;
+// Requested geometry and texture streaming bandwidth in KB/s above which scheduled precache points wait, 0 = unlimited
+static float e_PrecacheSchedulerBandwidth = 0.0f;
+// Megabytes streamed object and texture memory may grow by while precache points are active before further ones wait, 0 = unlimited
+static float e_PrecacheSchedulerMemory = 0.0f;
+// 1 = log completion, latency and streamed memory of every finished precache point
+static int e_PrecacheSchedulerLog = 0;
+// Answer box queries by render node type from a per type grid instead of walking the octree
+static int e_ObjectTypeIndex = 1;
+// Cell size in meters of the per type object grid
+static float e_ObjectTypeIndexCellSize = 32.0f;
+// Compression level of SaveInternalState snapshots, 0 stores them uncompressed
+static int e_StateSnapshotCompression = 0;
+// Store SaveInternalState snapshots as a delta against the previous one when its layout is unchanged,
+// only for receivers applying every snapshot
+static int e_StateSnapshotDelta = 0;
+// Seconds a position of e_SQTestRun may take to become resident before it counts as timed out
+static float e_SQTestRunTimeout = 30.0f;
+
 namespace
 {
 class CLoadLogListener : public ILoaderCGFListener
@@ -181,9 +209,16 @@ C3DEngine::C3DEngine(ISystem* pSystem)
 
 	m_nBlackTexID = 0;
 
+	m_nOctreeUpdateQueueHead = 0;
+
 	m_nCurWind = 0;
+	m_nSubmittedWind = -1;
 	m_bWindJobRun = false;
 	m_pWindField = NULL;
+	m_vWindTilesCentr.zero();
+	m_vWindTilesGlobalWind.zero();
+	m_fWindTilesAreaStrength = 0.0f;
+	m_nWindTilesUpdate = 0;
 
 	// create components
 	m_pObjManager = CryAlignedNew<CObjManager>();
@@ -476,6 +511,23 @@ void C3DEngine::RemoveEntInFoliage(int i, IPhysicalEntity* pent)
 	m_arrEntsInFoliage.DeleteLast();
 }
 
+static void StateSnapshotFullCmd(IConsoleCmdArgs* pArgs)
+{
+	Cry3DEngineBase::Get3DEngine()->ResetInternalStateBase();
+}
+
+#if !defined(_RELEASE)
+static void StreamingLatencyRunCmd(IConsoleCmdArgs* pArgs)
+{
+	if (pArgs->GetArgCount() < 2)
+	{
+		CryLogAlways("Usage: e_SQTestRun <positions file> [report file]");
+		return;
+	}
+	Cry3DEngineBase::Get3DEngine()->StartStreamingLatencyRun(pArgs->GetArg(1), pArgs->GetArgCount() > 2 ? pArgs->GetArg(2) : nullptr);
+}
+#endif
+
 bool C3DEngine::Init()
 {
 	m_pPartManager = CreateParticleManager(!gEnv->IsDedicated());
@@ -527,6 +579,49 @@ bool C3DEngine::Init()
 	}
 	SetFrameLodInfo(frameLodInfo);
 
+	if (!gEnv->pConsole->GetCVar("e_WindGridJobs"))
+	{
+		REGISTER_CVAR(e_WindGridJobs, 0, VF_NULL,
+		              "Number of jobs rasterizing horizontal bands of the wind grid (used with e_VegetationBending 2)\n"
+		              "0 = one job per worker thread, 1 = single job");
+		REGISTER_CVAR(e_OctreeUpdateBudget, 0.0f, VF_NULL,
+		              "Milliseconds per frame spent registering moved objects in the octree before further updates are deferred to later frames.\n"
+		              "Deferred objects keep their previous octree placement until processed. 0 = unlimited");
+		REGISTER_CVAR(e_OctreeUpdateStats, 0, VF_NULL,
+		              "Display octree registration counts, deferred update queue length and time of the last frame");
+		REGISTER_CVAR(e_PrecacheSchedulerMaxActive, 4, VF_NULL,
+		              "Scheduled precache points streaming at the same time. Points reaching their arrival time are always started");
+		REGISTER_CVAR(e_PrecacheSchedulerLeadTime, 2.0f, VF_NULL,
+		              "Seconds before their arrival time scheduled precache points may start streaming");
+		REGISTER_CVAR(e_PrecacheSchedulerBandwidth, 0.0f, VF_NULL,
+		              "Requested geometry and texture streaming bandwidth in KB/s above which scheduled precache points wait. 0 = unlimited");
+		REGISTER_CVAR(e_PrecacheSchedulerMemory, 0.0f, VF_NULL,
+		              "Megabytes streamed object and texture memory may grow by, engine wide, while precache points are active before further scheduled points wait. 0 = unlimited");
+		REGISTER_CVAR(e_PrecacheSchedulerLog, 0, VF_NULL,
+		              "Log completion, latency and streamed memory of every finished precache point");
+		REGISTER_CVAR(e_ObjectTypeIndex, 1, VF_NULL,
+		              "Answer GetObjectsByTypeInBox queries from a per render node type grid, built on the first query of a type");
+		REGISTER_CVAR(e_ObjectTypeIndexCellSize, 32.0f, VF_NULL,
+		              "Cell size in meters of the per render node type object grid, changing it rebuilds the grids");
+		REGISTER_CVAR(e_StateSnapshotCompression, 0, VF_NULL,
+		              "Compression level of engine state snapshots (LiveCreate, editor game mode), 0 stores them uncompressed");
+		REGISTER_CVAR(e_StateSnapshotDelta, 0, VF_NULL,
+		              "Store engine state snapshots as a delta against the previous snapshot when its layout is unchanged.\n"
+		              "The receiver has to apply every snapshot, use e_StateSnapshotFull after it missed one");
+		REGISTER_COMMAND("e_StateSnapshotFull", StateSnapshotFullCmd, VF_NULL,
+		                 "Makes the next engine state snapshot a full one, e.g. after a LiveCreate target reconnected");
+		REGISTER_CVAR(e_SQTestRunTimeout, 30.0f, VF_NULL,
+		              "Seconds a position of e_SQTestRun may take to become resident before it counts as timed out");
+#if !defined(_RELEASE)
+		REGISTER_COMMAND("e_SQTestRun", StreamingLatencyRunCmd, VF_NULL,
+		                 "Usage: e_SQTestRun <positions file> [report file]\n"
+		                 "Teleports the camera through the positions of the file, one 'x y z [pitch roll yaw]' per line,\n"
+		                 "measures the time until all requested textures, meshes and merged mesh sectors are resident\n"
+		                 "and writes an xml report, by default to %USER%/TestResults/Streaming_Latency_Run.xml.\n"
+		                 "Quits when done if e_SQTestExitOnFinish is set");
+#endif
+	}
+
 	m_colorGradingCtrl.Init();
 
 	return  (true);
@@ -568,6 +663,8 @@ void C3DEngine::OnFrameStart()
 	m_nRenderWorldUSecs = 0;
 	m_pDeferredPhysicsEventManager->Update();
 
+	ProcessOctreeUpdateQueue();
+
 #if defined(USE_GEOM_CACHES)
 	if (m_pGeomCacheManager && !m_bLevelLoadingInProgress)
 	{
@@ -631,6 +728,8 @@ void C3DEngine::Update()
 	if (GetCVars()->e_PrecacheLevel == 3)
 		PrecacheLevel(true, 0, 0);
 
+	UpdatePrecacheScheduler();
+
 	DebugDraw_Draw();
 
 	ProcessCVarsChange();
@@ -849,6 +948,8 @@ void C3DEngine::ShutDown()
 	UnlockCGFResources();
 
 	UnloadLevel();
+	ResetInternalStateBase();
+	InvalidateObjectTypeIndex();
 
 #if defined(USE_GEOM_CACHES)
 	SAFE_DELETE(m_pGeomCacheManager);
@@ -1114,6 +1215,198 @@ void C3DEngine::ProcessStreamingLatencyTest(const CCamera& camIn, CCamera& camOu
 		}
 	}
 }
+
+// Streamable textures used during the last frames that miss mips up to e_SQTestMip
+static int CountPendingStreamingTextures(int nMainFrameID, int nMip)
+{
+	int nPending = 0;
+	SRendererQueryGetAllTexturesParam param;
+	gEnv->pRenderer->EF_Query(EFQ_GetAllTextures, param);
+	if (param.pTextures)
+	{
+		for (uint32 i = 0; i < param.numTextures; i++)
+		{
+			ITexture* pTexture = param.pTextures[i];
+			if (pTexture->IsStreamable() && pTexture->GetAccessFrameId() > nMainFrameID - 4 && pTexture->GetMinLoadedMip() > nMip)
+				++nPending;
+		}
+	}
+	gEnv->pRenderer->EF_Query(EFQ_GetAllTexturesRelease, param);
+	return nPending;
+}
+
+bool C3DEngine::StartStreamingLatencyRun(const char* szPositionsFile, const char* szReportFile)
+{
+	FILE* f = gEnv->pCryPak->FOpen(szPositionsFile, "rt");
+	if (!f)
+	{
+		Warning("e_SQTestRun: could not open positions file %s", szPositionsFile);
+		return false;
+	}
+
+	SStreamingLatencyRun& run = m_streamingLatencyRun;
+	run = SStreamingLatencyRun();
+
+	char line[512];
+	while (gEnv->pCryPak->FGets(line, sizeof(line), f))
+	{
+		if (line[0] == '#' || line[0] == ';')
+			continue;
+
+		SStreamingLatencyRunPoint point;
+		memset(&point, 0, sizeof(point));
+		const int args = sscanf(line, "%f %f %f %f %f %f", &point.vPos.x, &point.vPos.y, &point.vPos.z, &point.vAngDeg.x, &point.vAngDeg.y, &point.vAngDeg.z);
+		if (args < 3)
+			continue;
+		point.bHasAngles = args >= 6;
+		run.points.push_back(point);
+	}
+	gEnv->pCryPak->FClose(f);
+
+	if (run.points.empty())
+	{
+		Warning("e_SQTestRun: no positions in %s", szPositionsFile);
+		return false;
+	}
+
+	run.reportPath = szReportFile && szReportFile[0] ? szReportFile : "%USER%/TestResults/Streaming_Latency_Run.xml";
+	run.fPointStartTime = GetCurTimeSec();
+	run.bActive = true;
+
+	PrintMessage("======== Starting streaming latency run, %d positions ========", (int)run.points.size());
+	return true;
+}
+
+void C3DEngine::ProcessStreamingLatencyRun(CCamera& camOut, const SRenderingPassInfo& passInfo)
+{
+	SStreamingLatencyRun& run = m_streamingLatencyRun;
+	SStreamingLatencyRunPoint& point = run.points[run.nCurrent];
+
+	// Keep the camera at the position for the whole measurement
+	Matrix34 mat = camOut.GetMatrix();
+	if (point.bHasAngles)
+		mat.SetRotation33(Matrix33::CreateRotationXYZ(DEG2RAD(point.vAngDeg)));
+	mat.SetTranslation(point.vPos);
+	camOut.SetMatrix(mat);
+
+	const float fNow = GetCurTimeSec();
+	++run.nFrames;
+
+	SStreamEngineOpenStats openStats;
+	gEnv->pSystem->GetStreamEngine()->GetStreamingOpenStatistics(openStats);
+
+	SObjectsStreamingStatus objectsStatus;
+	GetObjectsStreamingStatus(objectsStatus);
+
+	const int nPendingMeshes = objectsStatus.nInProgress;
+	const int nPendingSectors = (m_pMergedMeshesManager && GetCVars()->e_MergedMeshes) ? (int)m_pMergedMeshesManager->PendingStreamInNodes() : 0;
+
+	// Texture requests are collected from the draw calls, so the renderer is
+	// only asked every few frames and never without one
+	if (GetRenderer())
+	{
+		if ((run.nFrames & 7) == 0)
+			run.nPendingTextures = CountPendingStreamingTextures((int)passInfo.GetMainFrameID(), GetCVars()->e_SQTestMip);
+
+		STextureStreamingStats texturesStats(true);
+		GetRenderer()->EF_Query(EFQ_GetTexStreamingInfo, texturesStats);
+		point.nMaxTexUsage = max(point.nMaxTexUsage, texturesStats.nRequiredStreamedTexturesSize);
+	}
+
+	// Requests only show up once the streaming priorities were updated for the
+	// new position, so nothing counts as resident during the first frames
+	const int nMinFrames = 8;
+	const int nSettleFrames = 8;
+	const bool bResident = run.nFrames > nMinFrames && !openStats.nOpenRequestCount && !nPendingMeshes && !nPendingSectors && !run.nPendingTextures;
+	if (bResident)
+	{
+		if (!run.nSettledFrames++)
+			run.fSettledTime = fNow;
+	}
+	else
+	{
+		run.nSettledFrames = 0;
+		run.fSettledTime = -1.0f;
+	}
+
+	const bool bTimedOut = fNow - run.fPointStartTime > e_SQTestRunTimeout;
+	if (run.nSettledFrames < nSettleFrames && !bTimedOut)
+		return;
+
+	point.bTimedOut = run.nSettledFrames < nSettleFrames;
+	point.fLatency = point.bTimedOut ? fNow - run.fPointStartTime : run.fSettledTime - run.fPointStartTime;
+	point.nPendingTextures = point.bTimedOut ? run.nPendingTextures : 0;
+	point.nPendingMeshes = point.bTimedOut ? nPendingMeshes : 0;
+	point.nPendingMergedMeshSectors = point.bTimedOut ? nPendingSectors : 0;
+
+	PrintMessage("Streaming latency run %d/%d (%.1f, %.1f, %.1f): %.2f sec%s", (int)run.nCurrent + 1, (int)run.points.size(),
+	             point.vPos.x, point.vPos.y, point.vPos.z, point.fLatency, point.bTimedOut ? " (timed out)" : "");
+
+	// Next position
+	run.nFrames = 0;
+	run.nSettledFrames = 0;
+	run.fSettledTime = -1.0f;
+	run.nPendingTextures = 0;
+	run.fPointStartTime = fNow;
+	if (++run.nCurrent < run.points.size())
+		return;
+
+	run.bActive = false;
+	WriteStreamingLatencyRunReport();
+
+	if (GetCVars()->e_SQTestExitOnFinish)
+		GetSystem()->Quit();
+}
+
+void C3DEngine::WriteStreamingLatencyRunReport()
+{
+	const SStreamingLatencyRun& run = m_streamingLatencyRun;
+
+	float fTotal = 0.0f, fMax = 0.0f;
+	int nTimedOut = 0;
+	for (const SStreamingLatencyRunPoint& point : run.points)
+	{
+		fTotal += point.fLatency;
+		fMax = max(fMax, point.fLatency);
+		nTimedOut += point.bTimedOut ? 1 : 0;
+	}
+
+	gEnv->pCryPak->MakeDir(PathUtil::GetPathWithoutFilename(run.reportPath.c_str()));
+	CryPathString path;
+	gEnv->pCryPak->AdjustFileName(run.reportPath.c_str(), path, ICryPak::FLAGS_PATH_REAL | ICryPak::FLAGS_FOR_WRITING);
+
+	FILE* f = ::fopen(path, "wb");
+	if (!f)
+	{
+		Warning("e_SQTestRun: could not write report %s", path.c_str());
+		return;
+	}
+
+	fprintf(f,
+	        "<phase name=\"Streaming_Latency_Run\">\n"
+	        "<metrics name=\"Streaming\">\n"
+	        "<metric name=\"AvrLatency\" value=\"%.3f\"/>\n"
+	        "<metric name=\"MaxLatency\" value=\"%.3f\"/>\n"
+	        "<metric name=\"Positions\" value=\"%d\"/>\n"
+	        "<metric name=\"TimedOut\" value=\"%d\"/>\n"
+	        "</metrics>\n",
+	        fTotal / (float)run.points.size(), fMax, (int)run.points.size(), nTimedOut);
+
+	for (size_t i = 0; i < run.points.size(); ++i)
+	{
+		const SStreamingLatencyRunPoint& point = run.points[i];
+		fprintf(f,
+		        "<position index=\"%d\" x=\"%.2f\" y=\"%.2f\" z=\"%.2f\" latency=\"%.3f\" timedOut=\"%d\" "
+		        "pendingTextures=\"%d\" pendingMeshes=\"%d\" pendingMergedMeshSectors=\"%d\" maxTexUsageMB=\"%.1f\"/>\n",
+		        (int)i, point.vPos.x, point.vPos.y, point.vPos.z, point.fLatency, point.bTimedOut ? 1 : 0,
+		        point.nPendingTextures, point.nPendingMeshes, point.nPendingMergedMeshSectors, point.nMaxTexUsage / (1024.0f * 1024.0f));
+	}
+	fprintf(f, "</phase>\n");
+	::fclose(f);
+
+	PrintMessage("Streaming latency run finished: average %.2f sec, max %.2f sec, %d of %d timed out, report %s",
+	             fTotal / (float)run.points.size(), fMax, nTimedOut, (int)run.points.size(), path.c_str());
+}
 #endif
 
 //////////////////////////////////////////////////////////////////////
@@ -1175,6 +1468,8 @@ void C3DEngine::UpdateRenderingCamera(const char* szCallerName, const SRendering
 	}
 	if (GetCVars()->e_SQTestBegin)
 		ProcessStreamingLatencyTest(passInfo.GetCamera(), newCam, passInfo);
+	if (m_streamingLatencyRun.bActive)
+		ProcessStreamingLatencyRun(newCam, passInfo);
 
 #endif
 
@@ -1333,10 +1628,81 @@ IStatObj* C3DEngine::FindStatObjectByFilename(const char* filename)
 void C3DEngine::RegisterEntity(IRenderNode* pEnt)
 {
 	FUNCTION_PROFILER_3DENGINE;
+	++m_octreeUpdateStats.nRegisters;
+
+	// A queued update picks up the latest state of the node once it is processed
+	if (!m_octreeUpdateQueued.empty() && m_octreeUpdateQueued.find(pEnt) != m_octreeUpdateQueued.end())
+		return;
+
+	if (IsOctreeUpdateBudgetExhausted())
+	{
+		m_octreeUpdateQueued.insert(pEnt);
+		m_octreeUpdateQueue.push_back(pEnt);
+		++m_octreeUpdateStats.nDeferred;
+		return;
+	}
+
 	uint32 nFrameID = gEnv->nMainFrameID;
 	AsyncOctreeUpdate(pEnt, nFrameID, false);
 }
 
+bool C3DEngine::IsOctreeUpdateBudgetExhausted() const
+{
+	if (e_OctreeUpdateBudget <= 0.0f || m_bLevelLoadingInProgress)
+		return false;
+
+	return (float)((double)m_octreeUpdateStats.nTicks * 1000.0 / (double)CryGetTicksPerSec()) >= e_OctreeUpdateBudget;
+}
+
+void C3DEngine::ProcessOctreeUpdateQueue()
+{
+	FUNCTION_PROFILER_3DENGINE;
+
+	m_octreeUpdateStats.nQueueLength = (int)m_octreeUpdateQueued.size();
+	m_octreeUpdateStatsLast = m_octreeUpdateStats;
+	m_octreeUpdateStats.Reset();
+
+	// Updates deferred by earlier frames go first and share this frame's budget
+	const uint32 nFrameID = gEnv->nMainFrameID;
+	while (m_nOctreeUpdateQueueHead < m_octreeUpdateQueue.size() && !IsOctreeUpdateBudgetExhausted())
+	{
+		IRenderNode* pEnt = m_octreeUpdateQueue[m_nOctreeUpdateQueueHead++];
+
+		// Nodes unregistered or freed since they were queued left a stale entry
+		if (m_octreeUpdateQueued.erase(pEnt) == 0)
+			continue;
+
+		++m_octreeUpdateStats.nDequeued;
+		AsyncOctreeUpdate(pEnt, nFrameID, false);
+	}
+
+	if (m_nOctreeUpdateQueueHead == m_octreeUpdateQueue.size())
+	{
+		m_octreeUpdateQueue.clear();
+		m_nOctreeUpdateQueueHead = 0;
+	}
+	else if (m_nOctreeUpdateQueueHead > m_octreeUpdateQueue.size() / 2)
+	{
+		m_octreeUpdateQueue.erase(m_octreeUpdateQueue.begin(), m_octreeUpdateQueue.begin() + m_nOctreeUpdateQueueHead);
+		m_nOctreeUpdateQueueHead = 0;
+	}
+
+	if (e_OctreeUpdateStats)
+	{
+		const SOctreeUpdateStats& stats = m_octreeUpdateStatsLast;
+		float yPos = 120.f;
+		DrawTextLeftAligned(10.f, yPos, 1.2f, Col_White, "Octree updates: %d registered, %d same node, %d inserted, %d unregistered, %.3f ms",
+		                    stats.nRegisters, stats.nFastPath, stats.nInserts, stats.nUnregisters, (double)stats.nTicks * 1000.0 / (double)CryGetTicksPerSec());
+		DrawTextLeftAligned(10.f, yPos += 14.f, 1.2f, stats.nQueueLength ? Col_Yellow : Col_White, "Octree queue: %d deferred, %d processed, %d pending (budget %.2f ms)",
+		                    stats.nDeferred, stats.nDequeued, stats.nQueueLength, e_OctreeUpdateBudget);
+		for (int i = 0; i < eERType_TypesNum; ++i)
+		{
+			if (stats.arrTypeUpdates[i])
+				DrawTextLeftAligned(20.f, yPos += 14.f, 1.2f, Col_White, "render node type %2d: %d", i, stats.arrTypeUpdates[i]);
+		}
+	}
+}
+
 void C3DEngine::UnRegisterEntityDirect(IRenderNode* pEnt)
 {
 	UnRegisterEntityImpl(pEnt);
@@ -1979,6 +2345,8 @@ void C3DEngine::FreeRenderNodeState(IRenderNode* pEnt)
 {
 	FUNCTION_PROFILER_3DENGINE;
 
+	m_octreeUpdateQueued.erase(pEnt);
+
 	// make sure we don't try to update the streaming priority if an object
 	// was added and removed in the same frame
 	int nElementID = m_deferredRenderProxyStreamingPriorityUpdates.Find(pEnt);
@@ -3112,8 +3480,12 @@ bool C3DEngine::SampleWind(Vec3* pSamples, int nSamples, const AABB& volume, boo
 	Vec3 vWind = GetGlobalWind(bIndoors);
 
 	auto* pWindAreas = &m_outdoorWindAreas[m_nCurrentWindAreaList];
+	auto* pWindAreaGrid = &m_outdoorWindAreaGrid[m_nCurrentWindAreaList];
 	if (bIndoors)
+	{
 		pWindAreas = &m_indoorWindAreas[m_nCurrentWindAreaList];
+		pWindAreaGrid = &m_indoorWindAreaGrid[m_nCurrentWindAreaList];
+	}
 
 	for (int i = 0; i < nSamples; ++i)
 	{
@@ -3127,19 +3499,42 @@ bool C3DEngine::SampleWind(Vec3* pSamples, int nSamples, const AABB& volume, boo
 
 		int px = (int)pos.x;
 		int py = (int)pos.y;
-		// Iterate all areas, looking for wind areas. Skip first (global) area, and global wind.
-		for (const auto& windArea : *pWindAreas)
+		// Iterate the wind areas overlapping the grid cell of the sample
+		const uint32* pAreaIndex;
+		const uint32* pAreaIndexEnd;
+		pWindAreaGrid->Query(px, py, pAreaIndex, pAreaIndexEnd);
+		for (; pAreaIndex != pAreaIndexEnd; ++pAreaIndex)
 		{
+			const SOptimizedOutdoorWindArea& windArea = (*pWindAreas)[*pAreaIndex];
 			if (
 				px >= windArea.x0 &&
 				px <= windArea.x1 &&
 				py >= windArea.y0 &&
 				py <= windArea.y1)
 			{
-				// TODO: Interpolate wind position between corner points.
-				//float u, v, w;
-				//ComputerBarycentric2d(pos, windArea.pos[0], windArea.pos[1], windArea.pos[2], u, v, w);
-				pSamples[i] += windArea.windSpeed[4];
+				// Interpolate between the outer corner, the center and the neighbouring
+				// corners of the quadrant the sample is in, the same way the wind grid
+				// rasterizes the four quadrants of an area
+				const float u = (windArea.x1 > windArea.x0) ? (pos.x - windArea.x0) / (float)(windArea.x1 - windArea.x0) : 0.5f;
+				const float v = (windArea.y1 > windArea.y0) ? (pos.y - windArea.y0) / (float)(windArea.y1 - windArea.y0) : 0.5f;
+				const int qx = u >= 0.5f ? 1 : 0;
+				const int qy = v >= 0.5f ? 1 : 0;
+				const float s = clamp_tpl(qx ? (1.0f - u) * 2.0f : u * 2.0f, 0.0f, 1.0f);
+				const float t = clamp_tpl(qy ? (1.0f - v) * 2.0f : v * 2.0f, 0.0f, 1.0f);
+
+				// Corners are ordered min/min, max/min, max/max, min/max
+				static const int corner[2][2] = {
+					{ 0, 3 }, { 1, 2 }
+				};
+				const Vec3& vOuter = windArea.windSpeed[corner[qx][qy]];
+				const Vec3& vAdjX = windArea.windSpeed[corner[1 - qx][qy]];
+				const Vec3& vAdjY = windArea.windSpeed[corner[qx][1 - qy]];
+				const Vec3& vCenter = windArea.windSpeed[4];
+				Vec3 vEdge, vInner, vAreaWind;
+				vEdge.SetLerp(vOuter, vAdjX, s);
+				vInner.SetLerp(vAdjY, vCenter, s);
+				vAreaWind.SetLerp(vEdge, vInner, t);
+				pSamples[i] += vAreaWind;
 
 				//pe_status_area area;
 				//area.ctr = pos;
@@ -3153,6 +3548,131 @@ bool C3DEngine::SampleWind(Vec3* pSamples, int nSamples, const AABB& volume, boo
 	return true;
 }
 
+bool C3DEngine::SampleWindGrid(Vec3* pSamples, int nSamples, const AABB& volume, bool bIndoors) const
+{
+	if (!m_pCVars->e_Wind || nSamples == 0)
+		return false;
+
+	// The grid only holds outdoor wind, and only the buffer last submitted to
+	// the renderer is complete while the next one is being rasterized
+	const int nGrid = m_nSubmittedWind;
+	if (bIndoors || nGrid < 0 || !m_WindGrid[nGrid].m_pData || GetCVars()->e_VegetationBending != 2)
+		return SampleWind(pSamples, nSamples, volume, bIndoors);
+
+	FUNCTION_PROFILER_3DENGINE;
+
+	const SWindGrid& rWindGrid = m_WindGrid[nGrid];
+	const float fCellSize = rWindGrid.m_fCellSize;
+	const float fInvCellSize = 1.0f / fCellSize;
+	const Vec2 vGridMin = Vec2(rWindGrid.m_vCentr) - Vec2(rWindGrid.m_nWidth * fCellSize, rWindGrid.m_nHeight * fCellSize) * 0.5f;
+
+	// Must match the bending response the wind grid was rasterized with
+	const float fBEND_RESPONSE = 0.25f;
+	const float fMAX_BENDING = 2.f;
+
+	// The cells hold (global * e_WindBendingStrength + area * e_WindBendingAreaStrength)
+	// in bending space, which is mapped back to global + area wind
+	const Vec3 vGlobalWind = GetGlobalWind(false);
+	const float fGlobalStrength = GetCVars()->e_WindBendingStrength;
+	const float fAreaStrength = GetCVars()->e_WindBendingAreaStrength;
+	const float fInvAreaStrength = fAreaStrength > 0.0f ? 1.0f / fAreaStrength : 0.0f;
+	const Vec2 vGlobalBent = Vec2(vGlobalWind.x, vGlobalWind.y) * fGlobalStrength;
+
+	for (int i = 0; i < nSamples; ++i)
+	{
+		const Vec3 pos = pSamples[i];
+
+		// Cell values are taken at the cell centers
+		const float fx = (pos.x - vGridMin.x) * fInvCellSize - 0.5f;
+		const float fy = (pos.y - vGridMin.y) * fInvCellSize - 0.5f;
+		if (fx < 0.0f || fy < 0.0f || fx >= (float)(rWindGrid.m_nWidth - 1) || fy >= (float)(rWindGrid.m_nHeight - 1))
+		{
+			SampleWind(&pSamples[i], 1, volume, false);
+			continue;
+		}
+
+		const int x0 = (int)fx;
+		const int y0 = (int)fy;
+		const float tx = fx - (float)x0;
+		const float ty = fy - (float)y0;
+
+		const CryHalf2* pRow0 = &rWindGrid.m_pData[y0 * rWindGrid.m_nWidth + x0];
+		const CryHalf2* pRow1 = pRow0 + rWindGrid.m_nWidth;
+		const Vec2 b00(CryConvertHalfToFloat(pRow0[0].x), CryConvertHalfToFloat(pRow0[0].y));
+		const Vec2 b10(CryConvertHalfToFloat(pRow0[1].x), CryConvertHalfToFloat(pRow0[1].y));
+		const Vec2 b01(CryConvertHalfToFloat(pRow1[0].x), CryConvertHalfToFloat(pRow1[0].y));
+		const Vec2 b11(CryConvertHalfToFloat(pRow1[1].x), CryConvertHalfToFloat(pRow1[1].y));
+		const Vec2 b0 = b00 + (b10 - b00) * tx;
+		const Vec2 b1 = b01 + (b11 - b01) * tx;
+		const Vec2 vBend = b0 + (b1 - b0) * ty;
+
+		// Invert vBend = w * R * M / (M + |w| * R)
+		const float fBendLen = min(vBend.GetLength(), fMAX_BENDING * 0.999f);
+		const Vec2 vField = vBend * (fMAX_BENDING / (fBEND_RESPONSE * (fMAX_BENDING - fBendLen)));
+
+		const Vec2 vArea = (vField - vGlobalBent) * fInvAreaStrength;
+		pSamples[i] = Vec3(vGlobalWind.x + vArea.x, vGlobalWind.y + vArea.y, vGlobalWind.z);
+	}
+
+	return true;
+}
+
+void SWindAreaGrid::Build(const std::vector<SOptimizedOutdoorWindArea>& areas)
+{
+	// Keep the grid at most 64x64 cells
+	const int maxDim = 64;
+
+	cellStart.clear();
+	areaIndices.clear();
+	dimX = dimY = 0;
+	if (areas.empty())
+		return;
+
+	int x1 = areas[0].x1, y1 = areas[0].y1;
+	x0 = areas[0].x0;
+	y0 = areas[0].y0;
+	for (const auto& windArea : areas)
+	{
+		x0 = min(x0, windArea.x0);
+		y0 = min(y0, windArea.y0);
+		x1 = max(x1, windArea.x1);
+		y1 = max(y1, windArea.y1);
+	}
+	const int extent = max(x1 - x0, y1 - y0) + 1;
+	cellSize = max((extent + maxDim - 1) / maxDim, 1);
+	dimX = (x1 - x0) / cellSize + 1;
+	dimY = (y1 - y0) / cellSize + 1;
+
+	// Counting sort of the area indices into the cells, the second pass fills
+	// in the indices in area order and advances every offset to the next cell
+	cellStart.assign(dimX * dimY + 1, 0);
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (uint32 i = 0; i < areas.size(); ++i)
+		{
+			const SOptimizedOutdoorWindArea& windArea = areas[i];
+			for (int cy = (windArea.y0 - y0) / cellSize, cy1 = (windArea.y1 - y0) / cellSize; cy <= cy1; ++cy)
+				for (int cx = (windArea.x0 - x0) / cellSize, cx1 = (windArea.x1 - x0) / cellSize; cx <= cx1; ++cx)
+				{
+					const int cell = cx + cy * dimX;
+					if (pass == 0)
+						++cellStart[cell + 1];
+					else
+						areaIndices[cellStart[cell]++] = i;
+				}
+		}
+		if (pass == 0)
+		{
+			for (int cell = 0; cell < dimX * dimY; ++cell)
+				cellStart[cell + 1] += cellStart[cell];
+			areaIndices.resize(cellStart[dimX * dimY]);
+		}
+	}
+	for (int cell = dimX * dimY; cell > 0; --cell)
+		cellStart[cell] = cellStart[cell - 1];
+	cellStart[0] = 0;
+}
+
 IBreezeGenerator* C3DEngine::GetBreezeGenerator() const
 {
 	return Cry3DEngineBase::GetBreezeGenerator();
@@ -3251,7 +3771,131 @@ static inline __m128i approx_float_to_half_SSE2(__m128 f, __m128i& s)
 }
 #endif
 
+CForcedWindAreaRegistry::THandle CForcedWindAreaRegistry::Add(const SOptimizedOutdoorWindArea& area)
+{
+	uint32 slot;
+	if (!m_freeSlots.empty())
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		if (m_slots.size() > 0xffff)
+			return InvalidHandle;
+		slot = (uint32)m_slots.size();
+		SSlot newSlot;
+		newSlot.generation = 1;
+		m_slots.push_back(newSlot);
+	}
+	m_slots[slot].denseIndex = PendingIndex;
+
+	const THandle handle = ((THandle)m_slots[slot].generation << 16) | slot;
+	m_pendingAdds.push_back(TPendingAdd(handle, area));
+	return handle;
+}
+
+void CForcedWindAreaRegistry::Remove(THandle handle)
+{
+	if (!IsValid(handle))
+		return;
+
+	// Areas that were never flushed are dropped right away, their queued add is
+	// skipped by Flush() as the handle is stale then
+	const uint32 slot = SlotOf(handle);
+	if (m_slots[slot].denseIndex == PendingIndex)
+		FreeSlot(slot);
+	else
+		m_pendingRemoves.push_back(handle);
+}
+
+bool CForcedWindAreaRegistry::IsValid(THandle handle) const
+{
+	const uint32 slot = SlotOf(handle);
+	return handle != InvalidHandle && slot < m_slots.size() && m_slots[slot].generation == GenerationOf(handle) && m_slots[slot].denseIndex != FreeIndex;
+}
+
+void CForcedWindAreaRegistry::Flush()
+{
+	for (THandle handle : m_pendingRemoves)
+	{
+		if (IsValid(handle))
+			RemoveAt(m_slots[SlotOf(handle)].denseIndex);
+	}
+	m_pendingRemoves.clear();
+
+	for (const TPendingAdd& add : m_pendingAdds)
+	{
+		if (!IsValid(add.first))
+			continue;
+		m_slots[SlotOf(add.first)].denseIndex = (uint32)m_areas.size();
+		m_areas.push_back(add.second);
+		m_handles.push_back(add.first);
+	}
+	m_pendingAdds.clear();
+}
+
+void CForcedWindAreaRegistry::Fade(float fElapsedTime)
+{
+	const float fFade = max(1.0f - fElapsedTime, 0.0f);
+	for (uint32 i = 0; i < m_areas.size(); )
+	{
+		Vec3& vCenterWind = m_areas[i].windSpeed[4];
+		vCenterWind *= fFade;
+		if (vCenterWind.IsZero(0.001f))
+			RemoveAt(i); // Moves the last area to i
+		else
+			++i;
+	}
+}
+
+void CForcedWindAreaRegistry::Clear()
+{
+	if (m_areas.empty() && m_pendingAdds.empty())
+		return;
+
+	// Slots stay allocated so outstanding handles are invalidated by their generation
+	for (uint32 slot = 0; slot < m_slots.size(); ++slot)
+	{
+		if (m_slots[slot].denseIndex != FreeIndex)
+			FreeSlot(slot);
+	}
+	m_areas.clear();
+	m_handles.clear();
+	m_pendingAdds.clear();
+	m_pendingRemoves.clear();
+}
+
+void CForcedWindAreaRegistry::RemoveAt(uint32 denseIndex)
+{
+	FreeSlot(SlotOf(m_handles[denseIndex]));
+
+	const uint32 last = (uint32)m_areas.size() - 1;
+	if (denseIndex != last)
+	{
+		m_areas[denseIndex] = m_areas[last];
+		m_handles[denseIndex] = m_handles[last];
+		m_slots[SlotOf(m_handles[denseIndex])].denseIndex = denseIndex;
+	}
+	m_areas.pop_back();
+	m_handles.pop_back();
+}
+
+void CForcedWindAreaRegistry::FreeSlot(uint32 slot)
+{
+	SSlot& rSlot = m_slots[slot];
+	rSlot.denseIndex = FreeIndex;
+	if (++rSlot.generation == 0)
+		rSlot.generation = 1;
+	m_freeSlots.push_back(slot);
+}
+
 void C3DEngine::AddForcedWindArea(const Vec3& vPos, float fAmountOfForce, float fRadius)
+{
+	AddForcedWindAreaHandle(vPos, fAmountOfForce, fRadius);
+}
+
+CForcedWindAreaRegistry::THandle C3DEngine::AddForcedWindAreaHandle(const Vec3& vPos, float fAmountOfForce, float fRadius)
 {
 	SOptimizedOutdoorWindArea area;
 	area.point[4].x = vPos.x;
@@ -3277,10 +3921,20 @@ void C3DEngine::AddForcedWindArea(const Vec3& vPos, float fAmountOfForce, float
 	area.point[3].y = vPos.y + fRadius;
 	area.windSpeed[3] = Vec3(-0.01f, 0.01f, 0);
 
-	m_forcedWindAreas.push_back(area);
+	return m_forcedWindAreas.Add(area);
 }
 
-void C3DEngine::UpdateWindGridJobEntry(Vec3 vPos)
+void C3DEngine::RemoveForcedWindArea(CForcedWindAreaRegistry::THandle handle)
+{
+	m_forcedWindAreas.Remove(handle);
+}
+
+// Edge length in cells of the tiles the wind grid tracks for incremental updates
+static const int c_nWindTileSize = 16;
+// Distance to their wind below which the cells of a tile count as settled
+static const float c_fWindTileSettleThreshold = 0.001f;
+
+void C3DEngine::UpdateWindGridJobEntry(int nRowBegin, int nRowEnd)
 {
 	FUNCTION_PROFILER_3DENGINE
 
@@ -3289,39 +3943,35 @@ void C3DEngine::UpdateWindGridJobEntry(Vec3 vPos)
 	auto* pWindAreas = &m_outdoorWindAreas[m_nCurrentWindAreaList];
 	if (bIndoors)
 		pWindAreas = &m_indoorWindAreas[m_nCurrentWindAreaList];
-	Vec3 vGlobalWind = GetGlobalWind(bIndoors);
 
-	float fCurTime = gEnv->pTimer->GetCurrTime();
-	float fElapsedTime = fCurTime - m_fLastWindProcessedTime;
-	m_fLastWindProcessedTime = fCurTime;
-
-	bool bReset = false;
-	if (fElapsedTime >= 2.0f)
-		bReset = true;
-
-	if (!bReset)
+	const SWindGridUpdate& update = m_windGridUpdate;
+	if (!update.bReset)
 	{
-		RasterWindAreas(pWindAreas, fElapsedTime);
-
-		pWindAreas = &m_forcedWindAreas;
-		RasterWindAreas(pWindAreas, fElapsedTime);
+		RasterWindAreas(pWindAreas, bIndoors ? NULL : m_windAreaSkip.data(), update.fElapsedTime, nRowBegin, nRowEnd);
+		RasterWindAreas(m_forcedWindAreas.GetAreas(), NULL, update.fElapsedTime, nRowBegin, nRowEnd);
 	}
-	RasterGlobalWind(vGlobalWind, fElapsedTime, bReset);
+	RasterGlobalWind(update.vGlobalWind, update.fElapsedTime, update.bReset, nRowBegin, nRowEnd);
+	if (update.bReset)
+		return;
 
-	// Fade forced wind out
-	for (size_t i = 0; i < pWindAreas->size(); i++)
+	// Every update moves the cells towards their wind by at least the slower of
+	// the area and global interpolation. Tiles whose cells are within the
+	// threshold are settled in this buffer once it was written.
+	const float fDecay = 1.0f - min(min(update.fFrameTime, update.fElapsedTime) * 0.8f, 1.f);
+	const int nBufferBit = 1 << m_nCurWind;
+	const int nTilesX = m_WindGrid[m_nCurWind].m_nWidth / c_nWindTileSize;
+	for (int i = nRowBegin / c_nWindTileSize * nTilesX, e = nRowEnd / c_nWindTileSize * nTilesX; i < e; ++i)
 	{
-		SOptimizedOutdoorWindArea& WA = (*pWindAreas)[i];
-		WA.windSpeed[4].x *= 1.0f - fElapsedTime;
-		if (WA.windSpeed->IsZero(0.001f))
-		{
-			pWindAreas->erase(pWindAreas->begin() + i);
-			i--;
-		}
+		SWindTile& tile = m_windTiles[i];
+		if (tile.bUniform)
+			continue;
+		tile.fResidual *= fDecay;
+		if (tile.fResidual < c_fWindTileSettleThreshold)
+			tile.nSettledMask |= nBufferBit;
 	}
 }
 
-void C3DEngine::RasterWindAreas(std::vector<SOptimizedOutdoorWindArea>* pWindAreas, float fElapsedTime)
+void C3DEngine::RasterWindAreas(std::vector<SOptimizedOutdoorWindArea>* pWindAreas, const uint8* pSkipAreas, float fElapsedTime, int nRowBegin, int nRowEnd)
 {
 	// Don't update anything if there are no areas with wind
 	if (pWindAreas->size() == 0)
@@ -3329,127 +3979,60 @@ void C3DEngine::RasterWindAreas(std::vector<SOptimizedOutdoorWindArea>* pWindAre
 
 	SWindGrid& rWindGrid = m_WindGrid[m_nCurWind];
 
-	rWindGrid.m_vCentr = m_vWindFieldCamera;
-	rWindGrid.m_vCentr.z = 0;
-
 	float fSize = (float)rWindGrid.m_nWidth * rWindGrid.m_fCellSize;
 	Vec3 vHalfSize = Vec3(fSize * 0.5f, fSize * 0.5f, 0.0f);
 	AABB windBox(rWindGrid.m_vCentr - vHalfSize, rWindGrid.m_vCentr + vHalfSize);
 
-	// 1 Step: Rasterize wind areas
-	for (const auto& windArea : *pWindAreas)
+	// 1 Step: Rasterize wind areas, areas over settled tiles already left their final values
+	for (size_t i = 0; i < pWindAreas->size(); ++i)
 	{
+		if (pSkipAreas && pSkipAreas[i])
+			continue;
+
+		const SOptimizedOutdoorWindArea& windArea = (*pWindAreas)[i];
 		SOptimizedOutdoorWindArea WA = windArea;
 		WA.point[1].x = (WA.point[0].x + WA.point[1].x) * 0.5f;
 		WA.point[2] = WA.point[4];
 		WA.windSpeed[2] = WA.windSpeed[4];
 		WA.point[3].y = (WA.point[0].y + WA.point[3].y) * 0.5f;
-		UpdateWindGridArea(rWindGrid, WA, windBox);
+		UpdateWindGridArea(rWindGrid, WA, windBox, nRowBegin, nRowEnd);
 
 		WA = windArea;
 		WA.point[0].x = (WA.point[0].x + WA.point[1].x) * 0.5f;
 		WA.point[3] = WA.point[4];
 		WA.windSpeed[3] = WA.windSpeed[4];
 		WA.point[2].y = (WA.point[1].y + WA.point[2].y) * 0.5f;
-		UpdateWindGridArea(rWindGrid, WA, windBox);
+		UpdateWindGridArea(rWindGrid, WA, windBox, nRowBegin, nRowEnd);
 
 		WA = windArea;
 		WA.point[3].x = (WA.point[3].x + WA.point[2].x) * 0.5f;
 		WA.point[0] = WA.point[4];
 		WA.windSpeed[0] = WA.windSpeed[4];
 		WA.point[1].y = (WA.point[1].y + WA.point[2].y) * 0.5f;
-		UpdateWindGridArea(rWindGrid, WA, windBox);
+		UpdateWindGridArea(rWindGrid, WA, windBox, nRowBegin, nRowEnd);
 
 		WA = windArea;
 		WA.point[2].x = (WA.point[3].x + WA.point[2].x) * 0.5f;
 		WA.point[1] = WA.point[4];
 		WA.windSpeed[1] = WA.windSpeed[4];
 		WA.point[0].y = (WA.point[0].y + WA.point[3].y) * 0.5f;
-		UpdateWindGridArea(rWindGrid, WA, windBox);
+		UpdateWindGridArea(rWindGrid, WA, windBox, nRowBegin, nRowEnd);
 	}
 }
 
-void C3DEngine::RasterGlobalWind(const Vec3& vGlobalWind, float fElapsedTime, bool bReset)
+// Interpolates a span of wind grid cells towards the global wind, skipping the
+// cells a wind area was rasterized into this frame
+static void RasterGlobalWindSpan(CryHalf2* pDataSpan, int* pFramesSpan, Vec2* pFieldSpan, int nSize, const Vec2& vWindCur, float fInterp, int nFrame)
 {
 	const float fBEND_RESPONSE = 0.25f;
 	const float fMAX_BENDING = 2.f;
 
-	// Don't update anything if there are no areas with wind
-	if (vGlobalWind.IsZero())
-		return;
-
-	SWindGrid& rWindGrid = m_WindGrid[m_nCurWind];
-
 	int x;
-	rWindGrid.m_vCentr = m_vWindFieldCamera;
-	rWindGrid.m_vCentr.z = 0;
-
-	float fInterp = min(fElapsedTime * 0.8f, 1.f);
-
-	int nFrame = gEnv->nMainFrameID;
-
-	// 2 Step: Initialize the rest of the field by global wind value
-	const int nSize = rWindGrid.m_nWidth * rWindGrid.m_nHeight;
-	Vec2 vWindCur = Vec2(vGlobalWind.x, vGlobalWind.y) * GetCVars()->e_WindBendingStrength;
-
-	if (bReset)
-	{
-#if CRY_PLATFORM_SSE2
-		__m128i* pData = (__m128i*)&rWindGrid.m_pData[0];
-		__m128i* pFrames = (__m128i*)&m_pWindAreaFrames[0];
-		__m128* pField = (__m128*)&m_pWindField[0];
-
-		Vec2 vBend = vWindCur * fBEND_RESPONSE;
-		vBend *= fMAX_BENDING / (fMAX_BENDING + vBend.GetLength());
-
-		__m128 vBends = _mm_set_ps(vBend.y, vBend.x, vBend.y, vBend.x);
-
-	#if CRY_PLATFORM_F16C
-		__m128i hData = _mm_cvtps_ph(vBends, 0);
-		hData = _mm_unpacklo_epi64(hData, hData);
-	#else
-		__m128i hSign, hData = approx_float_to_half_SSE2(vBends, hSign);
-		hSign = _mm_packs_epi32(hSign, hSign);
-		hData = _mm_packs_epi32(hData, hData);
-		hData = _mm_or_si128(hSign, hData);
-	#endif
-
-		__m128i nFrames = _mm_set1_epi32(nFrame);
-		__m128 vWindCurs = _mm_set_ps(vWindCur.y, vWindCur.x, vWindCur.y, vWindCur.x);
-		for (x = 0; x < ((nSize + 3) / 4); ++x)
-		{
-			_mm_storeu_si128(pFrames + x, nFrames);
-
-			_mm_storeu_ps((float*)(pField + x * 2 + 0), vWindCurs);
-			_mm_storeu_ps((float*)(pField + x * 2 + 1), vWindCurs);
-
-			_mm_storeu_si128(pData + x, hData);
-		}
-#else
-		CryHalf2* pData = &rWindGrid.m_pData[0];
-		int* pFrames = &m_pWindAreaFrames[0];
-		Vec2* pField = &m_pWindField[0];
-
-		Vec2 vBend = vWindCur * fBEND_RESPONSE;
-		vBend *= fMAX_BENDING / (fMAX_BENDING + vBend.GetLength());
-		CryHalf2 vData = CryHalf2(vBend.x, vBend.y);
-
-		for (x = 0; x < nSize; x++)
-		{
-			// Test and update or skip
-			pFrames[x] = nFrame;
-			pField[x] = vWindCur;
-			pData[x] = vData;
-		}
-#endif
-		return;
-	}
-
 #if CRY_PLATFORM_SSE2
 	__m128i nFrames = _mm_set1_epi32(nFrame);
-	__m128i* pData = (__m128i*)&rWindGrid.m_pData[0];
-	__m128i* pFrames = (__m128i*)&m_pWindAreaFrames[0];
-	__m128* pField = (__m128*)&m_pWindField[0];
+	__m128i* pData = (__m128i*)pDataSpan;
+	__m128i* pFrames = (__m128i*)pFramesSpan;
+	__m128* pField = (__m128*)pFieldSpan;
 	__m128 vWindCurs = _mm_set_ps(vWindCur.y, vWindCur.x, vWindCur.y, vWindCur.x);
 	__m128 fInterps = _mm_set1_ps(fInterp);
 	__m128 fBendRps = _mm_set1_ps(fBEND_RESPONSE);
@@ -3517,9 +4100,9 @@ void C3DEngine::RasterGlobalWind(const Vec3& vGlobalWind, float fElapsedTime, bo
 		}
 	}
 #else
-	CryHalf2* pData = &rWindGrid.m_pData[0];
-	int* pFrames = &m_pWindAreaFrames[0];
-	Vec2* pField = &m_pWindField[0];
+	CryHalf2* pData = pDataSpan;
+	int* pFrames = pFramesSpan;
+	Vec2* pField = pFieldSpan;
 
 	for (x = 0; x < nSize; x++)
 	{
@@ -3542,8 +4125,165 @@ void C3DEngine::RasterGlobalWind(const Vec3& vGlobalWind, float fElapsedTime, bo
 #endif
 }
 
+void C3DEngine::RasterGlobalWind(const Vec3& vGlobalWind, float fElapsedTime, bool bReset, int nRowBegin, int nRowEnd)
+{
+	const float fBEND_RESPONSE = 0.25f;
+	const float fMAX_BENDING = 2.f;
+
+	// Don't update anything if there are no areas with wind
+	if (vGlobalWind.IsZero())
+		return;
+
+	const int nBufferBit = 1 << m_nCurWind;
+
+	SWindGrid& rWindGrid = m_WindGrid[m_nCurWind];
+
+	int x;
+	float fInterp = min(fElapsedTime * 0.8f, 1.f);
+
+	int nFrame = m_windGridUpdate.nFrameId;
+
+	// 2 Step: Initialize the rest of the field by global wind value
+	const int nFirst = nRowBegin * rWindGrid.m_nWidth;
+	const int nSize = (nRowEnd - nRowBegin) * rWindGrid.m_nWidth;
+	Vec2 vWindCur = Vec2(vGlobalWind.x, vGlobalWind.y) * GetCVars()->e_WindBendingStrength;
+
+	if (bReset)
+	{
+#if CRY_PLATFORM_SSE2
+		__m128i* pData = (__m128i*)&rWindGrid.m_pData[nFirst];
+		__m128i* pFrames = (__m128i*)&m_pWindAreaFrames[nFirst];
+		__m128* pField = (__m128*)&m_pWindField[nFirst];
+
+		Vec2 vBend = vWindCur * fBEND_RESPONSE;
+		vBend *= fMAX_BENDING / (fMAX_BENDING + vBend.GetLength());
+
+		__m128 vBends = _mm_set_ps(vBend.y, vBend.x, vBend.y, vBend.x);
+
+	#if CRY_PLATFORM_F16C
+		__m128i hData = _mm_cvtps_ph(vBends, 0);
+		hData = _mm_unpacklo_epi64(hData, hData);
+	#else
+		__m128i hSign, hData = approx_float_to_half_SSE2(vBends, hSign);
+		hSign = _mm_packs_epi32(hSign, hSign);
+		hData = _mm_packs_epi32(hData, hData);
+		hData = _mm_or_si128(hSign, hData);
+	#endif
+
+		__m128i nFrames = _mm_set1_epi32(nFrame);
+		__m128 vWindCurs = _mm_set_ps(vWindCur.y, vWindCur.x, vWindCur.y, vWindCur.x);
+		for (x = 0; x < ((nSize + 3) / 4); ++x)
+		{
+			_mm_storeu_si128(pFrames + x, nFrames);
+
+			_mm_storeu_ps((float*)(pField + x * 2 + 0), vWindCurs);
+			_mm_storeu_ps((float*)(pField + x * 2 + 1), vWindCurs);
+
+			_mm_storeu_si128(pData + x, hData);
+		}
+#else
+		CryHalf2* pData = &rWindGrid.m_pData[nFirst];
+		int* pFrames = &m_pWindAreaFrames[nFirst];
+		Vec2* pField = &m_pWindField[nFirst];
+
+		Vec2 vBend = vWindCur * fBEND_RESPONSE;
+		vBend *= fMAX_BENDING / (fMAX_BENDING + vBend.GetLength());
+		CryHalf2 vData = CryHalf2(vBend.x, vBend.y);
+
+		for (x = 0; x < nSize; x++)
+		{
+			// Test and update or skip
+			pFrames[x] = nFrame;
+			pField[x] = vWindCur;
+			pData[x] = vData;
+		}
+#endif
+		const int nTilesX = rWindGrid.m_nWidth / c_nWindTileSize;
+		for (int i = nRowBegin / c_nWindTileSize * nTilesX, e = nRowEnd / c_nWindTileSize * nTilesX; i < e; ++i)
+		{
+			SWindTile& tile = m_windTiles[i];
+			tile.vField = vWindCur;
+			tile.fResidual = 0.0f;
+			tile.bUniform = 1;
+			tile.nSettledMask = nBufferBit;
+		}
+		return;
+	}
+
+	// Tiles whose cells all share one wind value are interpolated once and
+	// filled, tiles already holding the settled value in this buffer are
+	// skipped. Only tiles wind areas were rasterized into since they last
+	// settled are interpolated per cell, tiles under areas that settled keep
+	// their cells.
+	const int nTilesX = rWindGrid.m_nWidth / c_nWindTileSize;
+	const int nTileY1 = nRowBegin / c_nWindTileSize;
+	const int nTileY2 = nRowEnd / c_nWindTileSize;
+	const float fSettledSq = sqr(c_fWindTileSettleThreshold);
+	for (int ty = nTileY1; ty < nTileY2; ++ty)
+	{
+		for (int tx = 0; tx < nTilesX; ++tx)
+		{
+			SWindTile& tile = m_windTiles[tx + ty * nTilesX];
+			const int nFirstCell = ty * c_nWindTileSize * rWindGrid.m_nWidth + tx * c_nWindTileSize;
+			if (!tile.bUniform && tile.fResidual < c_fWindTileSettleThreshold && (tile.nSettledMask & nBufferBit))
+				continue;
+			if (tile.bUniform && tile.nTouchedFrame != nFrame)
+			{
+				Vec2 vWindInt = tile.vField;
+				vWindInt += (vWindCur - vWindInt) * fInterp;
+				if ((vWindCur - vWindInt).GetLength2() < fSettledSq)
+					vWindInt = vWindCur;
+				if (vWindInt == tile.vField)
+				{
+					if (tile.nSettledMask & nBufferBit)
+						continue;
+					tile.nSettledMask |= nBufferBit;
+				}
+				else
+				{
+					tile.vField = vWindInt;
+					tile.nSettledMask = nBufferBit;
+				}
+
+				Vec2 vBend = vWindInt * fBEND_RESPONSE;
+				vBend *= fMAX_BENDING / (fMAX_BENDING + vBend.GetLength());
+				const CryHalf2 vData(vBend.x, vBend.y);
+				for (int y = 0; y < c_nWindTileSize; ++y)
+				{
+					const int nRow = nFirstCell + y * rWindGrid.m_nWidth;
+					for (x = 0; x < c_nWindTileSize; ++x)
+					{
+						m_pWindField[nRow + x] = vWindInt;
+						rWindGrid.m_pData[nRow + x] = vData;
+					}
+				}
+				continue;
+			}
+
+			float fMaxDeltaSq = 0.0f;
+			for (int y = 0; y < c_nWindTileSize; ++y)
+			{
+				const int nRow = nFirstCell + y * rWindGrid.m_nWidth;
+				RasterGlobalWindSpan(&rWindGrid.m_pData[nRow], &m_pWindAreaFrames[nRow], &m_pWindField[nRow], c_nWindTileSize, vWindCur, fInterp, nFrame);
+				for (x = 0; x < c_nWindTileSize; ++x)
+					fMaxDeltaSq = max(fMaxDeltaSq, (vWindCur - m_pWindField[nRow + x]).GetLength2());
+			}
+
+			// Once no area touches the tile anymore and its cells caught up with
+			// the global wind, the tile is handled as a whole again
+			if (tile.nTouchedFrame != nFrame && fMaxDeltaSq < fSettledSq)
+			{
+				tile.vField = vWindCur;
+				tile.fResidual = 0.0f;
+				tile.bUniform = 1;
+				tile.nSettledMask = 0;
+			}
+		}
+	}
+}
+
 //static int g_nWindError;
-void C3DEngine::UpdateWindGridArea(SWindGrid& rWindGrid, const SOptimizedOutdoorWindArea& windArea, const AABB& windBox)
+void C3DEngine::UpdateWindGridArea(SWindGrid& rWindGrid, const SOptimizedOutdoorWindArea& windArea, const AABB& windBox, int nRowBegin, int nRowEnd)
 {
 	//FUNCTION_PROFILER_3DENGINE
 	int x, y;
@@ -3554,11 +4294,12 @@ void C3DEngine::UpdateWindGridArea(SWindGrid& rWindGrid, const SOptimizedOutdoor
 	if (!windBox.ContainsBox2D(areaBox))
 		return;
 
-	Vec3 vGlobalWind = GetGlobalWind(false) * GetCVars()->e_WindBendingStrength;
+	const SWindGridUpdate& update = m_windGridUpdate;
+	Vec3 vGlobalWind = update.vGlobalWind * GetCVars()->e_WindBendingStrength;
 
-	float fInterp = min(gEnv->pTimer->GetFrameTime() * 0.8f, 1.f);
+	float fInterp = min(update.fFrameTime * 0.8f, 1.f);
 
-	int nFrame = gEnv->nMainFrameID;
+	int nFrame = update.nFrameId;
 
 	static const float fBEND_RESPONSE = 0.25f;
 	static const float fMAX_BENDING = 2.f;
@@ -3592,6 +4333,45 @@ void C3DEngine::UpdateWindGridArea(SWindGrid& rWindGrid, const SOptimizedOutdoor
 	int nYGrid = (int)vGridStart.y;
 	assert(nXGrid >= 0 && nXGrid + (nX2 - nX1) <= rWindGrid.m_nWidth);
 	assert(nYGrid >= 0 && nYGrid + (nY2 - nY1) <= rWindGrid.m_nHeight);
+
+	// Only rasterize the rows of the band this job owns
+	if (nYGrid < nRowBegin)
+	{
+		nY1 += nRowBegin - nYGrid;
+		nYGrid = nRowBegin;
+	}
+	nY2 = min(nY2, nY1 + (nRowEnd - nYGrid));
+	if (nY2 <= nY1)
+		return;
+
+	// The tiles under the area need per cell updates until their cells settled
+	// again. Tiles turning non-uniform move by at most the area wind. The
+	// vectorized scanlines below may write up to three cells past the end of
+	// the span, but never past the end of a row.
+	if (nX2 > nX1 && nY2 > nY1)
+	{
+		float fAreaWind = 0.0f;
+		for (int i = 0; i < 4; ++i)
+			fAreaWind = max(fAreaWind, windArea.windSpeed[i].GetLength() * GetCVars()->e_WindBendingAreaStrength);
+		const int nTilesX = rWindGrid.m_nWidth / c_nWindTileSize;
+		const int nTilesY = rWindGrid.m_nHeight / c_nWindTileSize;
+		const int nTileX1 = nXGrid / c_nWindTileSize;
+		const int nTileX2 = min((nXGrid + ((nX2 - nX1 + 3) & ~3) - 1) / c_nWindTileSize, nTilesX - 1);
+		const int nTileY1 = nYGrid / c_nWindTileSize;
+		const int nTileY2 = min((nYGrid + (nY2 - nY1) - 1) / c_nWindTileSize, nTilesY - 1);
+		for (int ty = nTileY1; ty <= nTileY2; ++ty)
+			for (int tx = nTileX1; tx <= nTileX2; ++tx)
+			{
+				SWindTile& tile = m_windTiles[tx + ty * nTilesX];
+				tile.nTouchedFrame = nFrame;
+				if (tile.bUniform)
+				{
+					tile.fResidual = max(tile.fResidual, fAreaWind + (tile.vField - Vec2(vGlobalWind.x, vGlobalWind.y)).GetLength());
+					tile.bUniform = 0;
+					tile.nSettledMask = 0;
+				}
+			}
+	}
 	for (y = nY1; y < nY2; y++)
 	{
 		// Setup scanline gradients
@@ -3608,6 +4388,11 @@ void C3DEngine::UpdateWindGridArea(SWindGrid& rWindGrid, const SOptimizedOutdoor
 		Vec2 vWindCur = Vec2(windStart.x, windStart.y) + Vec2(vGlobalWind.x, vGlobalWind.y);
 
 #if CRY_PLATFORM_SSE2
+		// Spans ending less than four cells before the right edge of the grid
+		// finish their last cells one by one, so no group spills into the
+		// next row, which might belong to another job's band
+		const int nGroups = (nXGrid + ((nSize + 3) & ~3) <= rWindGrid.m_nWidth) ? (nSize + 3) / 4 : nSize / 4;
+
 		__m128i xs;
 		__m128i nFrames = _mm_set1_epi32(nFrame);
 		__m128i nSizes = _mm_set_epi32(nSize - 3, nSize - 2, nSize - 1, nSize - 0);
@@ -3626,7 +4411,7 @@ void C3DEngine::UpdateWindGridArea(SWindGrid& rWindGrid, const SOptimizedOutdoor
 			xs = _mm_set1_epi32(x * 4);
 		}
 
-		for (; x < ((nSize + 3) / 4); ++x, xs = _mm_set1_epi32(x * 4))
+		for (; x < nGroups; ++x, xs = _mm_set1_epi32(x * 4))
 		{
 			// manage end alignment
 			__m128i cFrame = _mm_loadu_si128(pFrames + x);
@@ -3691,6 +4476,28 @@ void C3DEngine::UpdateWindGridArea(SWindGrid& rWindGrid, const SOptimizedOutdoor
 
 			vWindCurs = _mm_add_ps(vWindCurs, vWindDeltas);
 		}
+
+		if (nGroups * 4 < nSize)
+		{
+			CryHalf2* pDataTail = &rWindGrid.m_pData[nYGrid * rWindGrid.m_nWidth + nXGrid];
+			int* pFramesTail = &m_pWindAreaFrames[nYGrid * rWindGrid.m_nWidth + nXGrid];
+			Vec2* pFieldTail = &m_pWindField[nYGrid * rWindGrid.m_nWidth + nXGrid];
+
+			// Same wind as the group the cells would have been part of
+			const Vec2 vWindTail = vWindCur + Vec2(windDelta.x, windDelta.y) * (float)nGroups;
+			for (x = nGroups * 4; x < nSize; x++)
+			{
+				pFramesTail[x] = nFrame;
+
+				Vec2 vWindInt = pFieldTail[x];
+				vWindInt += (vWindTail - vWindInt) * fInterp;
+				pFieldTail[x] = vWindInt;
+
+				Vec2 vBend = vWindInt * fBEND_RESPONSE;
+				vBend *= fMAX_BENDING / (fMAX_BENDING + vBend.GetLength());
+				pDataTail[x] = CryHalf2(vBend.x, vBend.y);
+			}
+		}
 #else
 		CryHalf2* pData = &rWindGrid.m_pData[nYGrid * rWindGrid.m_nWidth + nXGrid];
 		int* pFrames = &m_pWindAreaFrames[nYGrid * rWindGrid.m_nWidth + nXGrid];
@@ -3719,13 +4526,200 @@ void C3DEngine::UpdateWindGridArea(SWindGrid& rWindGrid, const SOptimizedOutdoor
 	}
 }
 
+static float WindAreaMaxSpeed(const Vec3* windSpeed)
+{
+	float fSpeed = 0.0f;
+	for (int i = 0; i < 5; ++i)
+		fSpeed = max(fSpeed, windSpeed[i].GetLength());
+	return fSpeed;
+}
+
+bool C3DEngine::GetWindAreaTiles(const SWindGrid& rWindGrid, const Vec2* point, Vec2i& vTileMin, Vec2i& vTileMax) const
+{
+	// Same cells UpdateWindGridArea rasterizes the area into
+	const float fSize = (float)rWindGrid.m_nWidth * rWindGrid.m_fCellSize;
+	const Vec3 vHalfSize = Vec3(fSize * 0.5f, fSize * 0.5f, 0.0f);
+	const AABB windBox(rWindGrid.m_vCentr - vHalfSize, rWindGrid.m_vCentr + vHalfSize);
+	const AABB areaBox(point[0], point[2]);
+	if (!windBox.ContainsBox2D(areaBox))
+		return false;
+
+	AABB windBoxC = windBox;
+	windBoxC.ClipToBox(areaBox);
+	const int nSizeX = (int)windBoxC.max.x - (int)windBoxC.min.x;
+	const int nSizeY = (int)windBoxC.max.y - (int)windBoxC.min.y;
+	if (nSizeX <= 0 || nSizeY <= 0)
+		return false;
+
+	const int nXGrid = (int)(windBoxC.min.x - windBox.min.x);
+	const int nYGrid = (int)(windBoxC.min.y - windBox.min.y);
+	vTileMin.x = nXGrid / c_nWindTileSize;
+	vTileMin.y = nYGrid / c_nWindTileSize;
+	vTileMax.x = min((nXGrid + ((nSizeX + 3) & ~3) - 1) / c_nWindTileSize, rWindGrid.m_nWidth / c_nWindTileSize - 1);
+	vTileMax.y = min((nYGrid + nSizeY - 1) / c_nWindTileSize, rWindGrid.m_nHeight / c_nWindTileSize - 1);
+	return true;
+}
+
+void C3DEngine::MarkWindTilesDirty(const SWindGrid& rWindGrid, const Vec2* point, float fResidual)
+{
+	Vec2i vTileMin, vTileMax;
+	if (!GetWindAreaTiles(rWindGrid, point, vTileMin, vTileMax))
+		return;
+
+	const int nTilesX = rWindGrid.m_nWidth / c_nWindTileSize;
+	for (int ty = vTileMin.y; ty <= vTileMax.y; ++ty)
+		for (int tx = vTileMin.x; tx <= vTileMax.x; ++tx)
+		{
+			SWindTile& tile = m_windTiles[tx + ty * nTilesX];
+			tile.fResidual = max(tile.fResidual, fResidual);
+			tile.nSettledMask = 0;
+		}
+}
+
+bool C3DEngine::AreWindTilesSettled(const SWindGrid& rWindGrid, const Vec2* point, int nBufferBit) const
+{
+	Vec2i vTileMin, vTileMax;
+	if (!GetWindAreaTiles(rWindGrid, point, vTileMin, vTileMax))
+		return true;
+
+	const int nTilesX = rWindGrid.m_nWidth / c_nWindTileSize;
+	for (int ty = vTileMin.y; ty <= vTileMax.y; ++ty)
+		for (int tx = vTileMin.x; tx <= vTileMax.x; ++tx)
+		{
+			const SWindTile& tile = m_windTiles[tx + ty * nTilesX];
+			if (tile.bUniform || tile.fResidual >= c_fWindTileSettleThreshold || !(tile.nSettledMask & nBufferBit))
+				return false;
+		}
+	return true;
+}
+
+// Marks the tiles under added, removed and changed wind areas dirty and flags
+// the outdoor areas whose tiles all settled, those are not rasterized again.
+// Runs on the main thread before the wind grid jobs are started.
+void C3DEngine::UpdateWindTileStates(const SWindGrid& rWindGrid)
+{
+	const std::vector<SOptimizedOutdoorWindArea>& areas = m_outdoorWindAreas[m_nCurrentWindAreaList];
+	const std::vector<SOptimizedOutdoorWindArea>& forcedAreas = *m_forcedWindAreas.GetAreas();
+	const float fAreaStrength = GetCVars()->e_WindBendingAreaStrength;
+	const Vec3 vGlobalWind = m_windGridUpdate.vGlobalWind * GetCVars()->e_WindBendingStrength;
+	m_windAreaSkip.assign(areas.size(), 0);
+
+	if (m_windGridUpdate.bReset)
+	{
+		// The reset fills the whole grid with the global wind, every area is new afterwards
+		m_windAreaStates.clear();
+		m_vWindTilesCentr = rWindGrid.m_vCentr;
+		m_vWindTilesGlobalWind = vGlobalWind;
+		m_fWindTilesAreaStrength = fAreaStrength;
+		return;
+	}
+
+	// The cells move with the grid center, every cell may then be off by the
+	// strongest area wind on both the old and the new position
+	if (m_vWindTilesCentr != rWindGrid.m_vCentr || m_fWindTilesAreaStrength != fAreaStrength)
+	{
+		float fMaxAreaWind = 0.0f;
+		for (const auto& state : m_windAreaStates)
+			fMaxAreaWind = max(fMaxAreaWind, WindAreaMaxSpeed(state.second.windSpeed) * m_fWindTilesAreaStrength);
+		for (const auto& windArea : areas)
+			fMaxAreaWind = max(fMaxAreaWind, WindAreaMaxSpeed(windArea.windSpeed) * fAreaStrength);
+		for (SWindTile& tile : m_windTiles)
+		{
+			if (!tile.bUniform)
+			{
+				tile.fResidual = max(tile.fResidual, fMaxAreaWind * 2.0f);
+				tile.nSettledMask = 0;
+			}
+		}
+		m_windAreaStates.clear();
+		m_vWindTilesCentr = rWindGrid.m_vCentr;
+		m_fWindTilesAreaStrength = fAreaStrength;
+	}
+
+	// Uniform tiles follow the global wind as a whole, the others per cell
+	if (m_vWindTilesGlobalWind != vGlobalWind)
+	{
+		const float fResidual = Vec2(vGlobalWind - m_vWindTilesGlobalWind).GetLength();
+		for (SWindTile& tile : m_windTiles)
+		{
+			if (!tile.bUniform)
+			{
+				tile.fResidual = max(tile.fResidual, fResidual);
+				tile.nSettledMask = 0;
+			}
+		}
+		m_vWindTilesGlobalWind = vGlobalWind;
+	}
+
+	const int nUpdate = ++m_nWindTilesUpdate;
+	for (const auto& windArea : areas)
+	{
+		if (!windArea.pArea)
+		{
+			MarkWindTilesDirty(rWindGrid, windArea.point, WindAreaMaxSpeed(windArea.windSpeed) * fAreaStrength);
+			continue;
+		}
+
+		auto it = m_windAreaStates.find(windArea.pArea);
+		if (it == m_windAreaStates.end())
+		{
+			MarkWindTilesDirty(rWindGrid, windArea.point, WindAreaMaxSpeed(windArea.windSpeed) * fAreaStrength);
+			it = m_windAreaStates.insert(std::make_pair(windArea.pArea, SWindAreaState())).first;
+		}
+		else
+		{
+			SWindAreaState& state = it->second;
+			if (memcmp(state.point, windArea.point, sizeof(state.point)) != 0)
+			{
+				MarkWindTilesDirty(rWindGrid, state.point, WindAreaMaxSpeed(state.windSpeed) * fAreaStrength);
+				MarkWindTilesDirty(rWindGrid, windArea.point, WindAreaMaxSpeed(windArea.windSpeed) * fAreaStrength);
+			}
+			else
+			{
+				float fResidual = 0.0f;
+				for (int i = 0; i < 5; ++i)
+					fResidual = max(fResidual, (windArea.windSpeed[i] - state.windSpeed[i]).GetLength() * fAreaStrength);
+				if (fResidual > 0.0f)
+					MarkWindTilesDirty(rWindGrid, windArea.point, fResidual);
+			}
+		}
+
+		SWindAreaState& state = it->second;
+		memcpy(state.point, windArea.point, sizeof(state.point));
+		memcpy(state.windSpeed, windArea.windSpeed, sizeof(state.windSpeed));
+		state.nUpdate = nUpdate;
+	}
+
+	for (auto it = m_windAreaStates.begin(); it != m_windAreaStates.end(); )
+	{
+		if (it->second.nUpdate != nUpdate)
+		{
+			MarkWindTilesDirty(rWindGrid, it->second.point, WindAreaMaxSpeed(it->second.windSpeed) * fAreaStrength);
+			it = m_windAreaStates.erase(it);
+		}
+		else
+			++it;
+	}
+
+	// Forced areas fade every update
+	for (const auto& windArea : forcedAreas)
+		MarkWindTilesDirty(rWindGrid, windArea.point, WindAreaMaxSpeed(windArea.windSpeed) * fAreaStrength);
+
+	const int nBufferBit = 1 << m_nCurWind;
+	for (size_t i = 0; i < areas.size(); ++i)
+		m_windAreaSkip[i] = areas[i].pArea && AreWindTilesSettled(rWindGrid, areas[i].point, nBufferBit);
+}
+
 DECLARE_JOB("C3DEngine::UpdateWindGridJobEntry", TUpdateWindJob, C3DEngine::UpdateWindGridJobEntry);
 
 void C3DEngine::StartWindGridJob(const Vec3& vPos)
 {
 	if (GetCVars()->e_VegetationBending != 2)
 	{
+		// the last submitted grid is not updated anymore
+		m_nSubmittedWind = -1;
 		m_bWindJobRun = false;
+		m_windAreaStates.clear();
 		return;
 	}
 	MEMSTAT_CONTEXT(EMemStatContextType::Other, "Start Wind Grid Job");
@@ -3746,9 +4740,25 @@ void C3DEngine::StartWindGridJob(const Vec3& vPos)
 
 			m_pWindAreaFrames = reinterpret_cast<int*>(CryModuleMemalign(rWindGrid.m_nWidth * rWindGrid.m_nHeight * sizeof(int), CRY_PLATFORM_ALIGNMENT));
 			memset(m_pWindAreaFrames, 0, rWindGrid.m_nWidth * rWindGrid.m_nHeight * sizeof(int));
+
+			assert(rWindGrid.m_nWidth % c_nWindTileSize == 0 && rWindGrid.m_nHeight % c_nWindTileSize == 0);
+			m_windTiles.assign((rWindGrid.m_nWidth / c_nWindTileSize) * (rWindGrid.m_nHeight / c_nWindTileSize), SWindTile());
 		}
 	}
 	m_vWindFieldCamera = m_RenderingCamera.GetPosition();
+	rWindGrid.m_vCentr = m_vWindFieldCamera;
+	rWindGrid.m_vCentr.z = 0;
+
+	// Per update parameters are resolved here once, so every band of the grid
+	// sees the same values
+	float fCurTime = gEnv->pTimer->GetCurrTime();
+	m_windGridUpdate.vGlobalWind = GetGlobalWind(false);
+	m_windGridUpdate.fElapsedTime = fCurTime - m_fLastWindProcessedTime;
+	m_windGridUpdate.fFrameTime = gEnv->pTimer->GetFrameTime();
+	m_windGridUpdate.nFrameId = gEnv->nMainFrameID;
+	UpdateWindTileStates(rWindGrid);
+	m_windGridUpdate.bReset = m_windGridUpdate.fElapsedTime >= 2.0f;
+	m_fLastWindProcessedTime = fCurTime;
 
 	/*auto* pWindAreas = &m_outdoorWindAreas[m_nCurrentWindAreaList];
 	   if (pWindAreas->size())
@@ -3785,15 +4795,25 @@ void C3DEngine::StartWindGridJob(const Vec3& vPos)
 
 	JobManager::SJobState* pJobState = &m_WindJobState;
 
-	TUpdateWindJob job(vPos);
-	job.RegisterJobState(pJobState);
-	job.SetClassInstance(this);
-	job.SetPriorityLevel(JobManager::eLowPriority);
-	job.Run();
+	// Split the grid into bands of whole tile rows, each band is rasterized
+	// by its own job and only writes to its own rows and tiles
+	const int nTileRows = rWindGrid.m_nHeight / c_nWindTileSize;
+	int nJobs = e_WindGridJobs > 0 ? e_WindGridJobs : (int)gEnv->pJobManager->GetNumWorkerThreads();
+	nJobs = clamp_tpl(nJobs, 1, nTileRows);
+	const int nBandRows = ((nTileRows + nJobs - 1) / nJobs) * c_nWindTileSize;
+
+	for (int nRowBegin = 0; nRowBegin < rWindGrid.m_nHeight; nRowBegin += nBandRows)
+	{
+		TUpdateWindJob job(nRowBegin, min(nRowBegin + nBandRows, rWindGrid.m_nHeight));
+		job.RegisterJobState(pJobState);
+		job.SetClassInstance(this);
+		job.SetPriorityLevel(JobManager::eLowPriority);
+		job.Run();
+	}
 
 	m_bWindJobRun = true;
 
-	//UpdateWindGridJobEntry(vPos);
+	//UpdateWindGridJobEntry(0, rWindGrid.m_nHeight);
 	//m_bWindJobRun = false;
 }
 void C3DEngine::FinishWindGridJob()
@@ -3803,7 +4823,13 @@ void C3DEngine::FinishWindGridJob()
 	{
 		gEnv->GetJobManager()->WaitForJob(m_WindJobState);
 
+		// All bands are done, the forced areas they read can be faded and
+		// changed now
+		m_forcedWindAreas.Fade(m_windGridUpdate.fElapsedTime);
+		m_forcedWindAreas.Flush();
+
 		GetRenderer()->EF_SubmitWind(&m_WindGrid[m_nCurWind]);
+		m_nSubmittedWind = m_nCurWind;
 		m_nCurWind = 1 - m_nCurWind;
 
 		m_bWindJobRun = false;
@@ -3991,10 +5017,17 @@ void C3DEngine::UpdateWindAreas()
 		std::sort(m_outdoorWindAreas[nextWindAreaList].begin(), m_outdoorWindAreas[nextWindAreaList].end(), [](const SOptimizedOutdoorWindArea& a, const SOptimizedOutdoorWindArea& b) { return a.x0 < b.x0; });
 		std::sort(m_indoorWindAreas[nextWindAreaList].begin(), m_indoorWindAreas[nextWindAreaList].end(), [](const SOptimizedOutdoorWindArea& a, const SOptimizedOutdoorWindArea& b) { return a.x0 < b.x0; });
 	}
+	m_outdoorWindAreaGrid[nextWindAreaList].Build(m_outdoorWindAreas[nextWindAreaList]);
+	m_indoorWindAreaGrid[nextWindAreaList].Build(m_indoorWindAreas[nextWindAreaList]);
 
 	// Don't update if: No areas and global wind is constant
 	Vec3 vGlobalWind = GetGlobalWind(false) * GetCVars()->e_WindBendingStrength;
-	int nCurAreas = m_outdoorWindAreas[m_nCurrentWindAreaList].size() + m_forcedWindAreas.size();
+	// Forced areas only feed the wind grid
+	if (GetCVars()->e_VegetationBending != 2)
+		m_forcedWindAreas.Clear();
+	else if (!m_bWindJobRun)
+		m_forcedWindAreas.Flush();
+	int nCurAreas = m_outdoorWindAreas[m_nCurrentWindAreaList].size() + m_forcedWindAreas.GetCount();
 	if (m_nProcessedWindAreas || nCurAreas || m_vProcessedGlobalWind != vGlobalWind)
 	{
 		m_nProcessedWindAreas = nCurAreas;
@@ -4326,6 +5359,10 @@ void C3DEngine::PrecacheLevel(bool bPrecacheAllVisAreas, Vec3* pPrecachePoints,
 }
 
 //////////////////////////////////////////////////////////////////////////
+static SPostEffectParamHandle s_photoFilterColorParam("clr_ColorGrading_PhotoFilterColor");
+static SPostEffectParamHandle s_photoFilterColorDensityParam("ColorGrading_PhotoFilterColorDensity");
+static SPostEffectParamHandle s_grainAmountParam("ColorGrading_GrainAmount");
+
 void C3DEngine::SetGlobalParameter(E3DEngineParameter param, const Vec3& v)
 {
 	float fValue = v.x;
@@ -4473,15 +5510,15 @@ void C3DEngine::SetGlobalParameter(E3DEngineParameter param, const Vec3& v)
 		break;
 	case E3DPARAM_COLORGRADING_FILTERS_PHOTOFILTER_COLOR:
 		m_pPhotoFilterColor = Vec4(v.x, v.y, v.z, 1);
-		SetPostEffectParamVec4("clr_ColorGrading_PhotoFilterColor", m_pPhotoFilterColor);
+		SetPostEffectParamVec4ByHandle(s_photoFilterColorParam.Get(), m_pPhotoFilterColor);
 		break;
 	case E3DPARAM_COLORGRADING_FILTERS_PHOTOFILTER_DENSITY:
 		m_fPhotoFilterColorDensity = fValue;
-		SetPostEffectParam("ColorGrading_PhotoFilterColorDensity", m_fPhotoFilterColorDensity);
+		SetPostEffectParamByHandle(s_photoFilterColorDensityParam.Get(), m_fPhotoFilterColorDensity);
 		break;
 	case E3DPARAM_COLORGRADING_FILTERS_GRAIN:
 		m_fGrainAmount = fValue;
-		SetPostEffectParam("ColorGrading_GrainAmount", m_fGrainAmount);
+		SetPostEffectParamByHandle(s_grainAmountParam.Get(), m_fGrainAmount);
 		break;
 	case E3DPARAM_SKY_SKYBOX_ANGLE: // sky box rotation
 		m_fSkyBoxAngle = fValue;
@@ -4846,6 +5883,39 @@ void C3DEngine::GetGlobalParameter(E3DEngineParameter param, Vec3& v)
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////
+int32 C3DEngine::GetPostEffectParamHandle(const char* pParam) const
+{
+	if (GetRenderer())
+		return GetRenderer()->EF_GetPostEffectParamHandle(pParam);
+
+	return -1;
+}
+
+void C3DEngine::SetPostEffectParamByHandle(int32 nHandle, float fValue, bool bForceValue) const
+{
+	if (GetRenderer() && nHandle >= 0)
+		GetRenderer()->EF_SetPostEffectParamByHandle(nHandle, fValue, bForceValue);
+}
+
+void C3DEngine::SetPostEffectParamVec4ByHandle(int32 nHandle, const Vec4& pValue, bool bForceValue) const
+{
+	if (GetRenderer() && nHandle >= 0)
+		GetRenderer()->EF_SetPostEffectParamVec4ByHandle(nHandle, pValue, bForceValue);
+}
+
+void C3DEngine::GetPostEffectParamByHandle(int32 nHandle, float& fValue) const
+{
+	if (GetRenderer() && nHandle >= 0)
+		GetRenderer()->EF_GetPostEffectParamByHandle(nHandle, fValue);
+}
+
+void C3DEngine::GetPostEffectParamVec4ByHandle(int32 nHandle, Vec4& pValue) const
+{
+	if (GetRenderer() && nHandle >= 0)
+		GetRenderer()->EF_GetPostEffectParamVec4ByHandle(nHandle, pValue);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 void C3DEngine::SetCachedShadowBounds(const AABB& shadowBounds, float fAdditionalCascadesScale)
@@ -4999,75 +6069,306 @@ SRenderNodeTempData* C3DEngine::CheckAndCreateRenderNodeTempData(IRenderNode* pR
 			}
 		}
 
-		pRNode->m_manipulationFrame = currentFrame;
+		pRNode->m_manipulationFrame = currentFrame;
+	}
+
+	CRY_ASSERT(pTempData);
+	if (!pTempData)
+		return nullptr;
+
+	if (!m_visibleNodesManager.SetLastSeenFrame(pTempData, passInfo))
+		pTempData = nullptr;
+
+	return pTempData;
+}
+
+void C3DEngine::CopyObjectsByType(EERType objType, const AABB* pBox, PodArray<IRenderNode*>* plstObjects, uint64 dwFlags)
+{
+	GetObjectsByTypeGlobal(*plstObjects, objType, pBox, 0, dwFlags);
+
+	if (GetVisAreaManager())
+		GetVisAreaManager()->GetObjectsByType(*plstObjects, objType, pBox, 0, dwFlags);
+}
+
+void C3DEngine::CopyObjects(const AABB* pBox, PodArray<IRenderNode*>* plstObjects)
+{
+	m_pObjectsTree->GetObjects(*plstObjects, pBox);
+
+	if (GetVisAreaManager())
+		GetVisAreaManager()->GetObjects(*plstObjects, pBox);
+}
+
+uint32 C3DEngine::GetObjectsByType(EERType objType, IRenderNode** pObjects)
+{
+	PodArray<IRenderNode*> lstObjects;
+	CopyObjectsByType(objType, NULL, &lstObjects);
+	if (pObjects && !lstObjects.IsEmpty())
+		memcpy(pObjects, &lstObjects[0], lstObjects.GetDataSize());
+	return lstObjects.Count();
+}
+
+uint32 C3DEngine::GetObjectsByTypeInBox(EERType objType, const AABB& bbox, IRenderNode** pObjects, uint64 dwFlags)
+{
+	PodArray<IRenderNode*> lstObjects;
+	if (!QueryObjectTypeIndex(objType, bbox, lstObjects, dwFlags))
+		CopyObjectsByType(objType, &bbox, &lstObjects, dwFlags);
+	if (pObjects && !lstObjects.IsEmpty())
+		memcpy(pObjects, &lstObjects[0], lstObjects.GetDataSize());
+	return lstObjects.Count();
+}
+
+uint32 C3DEngine::GetObjectsByTypeInBoxes(EERType objType, const AABB* pBoxes, uint32 nBoxes, IRenderNode** pObjects, uint32* pCounts, uint64 dwFlags)
+{
+	FUNCTION_PROFILER_3DENGINE;
+
+	PodArray<IRenderNode*> lstObjects;
+	uint32 nTotal = 0;
+	for (uint32 i = 0; i < nBoxes; ++i)
+	{
+		lstObjects.Clear();
+		if (!QueryObjectTypeIndex(objType, pBoxes[i], lstObjects, dwFlags))
+			CopyObjectsByType(objType, &pBoxes[i], &lstObjects, dwFlags);
+		if (pObjects && !lstObjects.IsEmpty())
+			memcpy(pObjects + nTotal, &lstObjects[0], lstObjects.GetDataSize());
+		if (pCounts)
+			pCounts[i] = lstObjects.Count();
+		nTotal += lstObjects.Count();
+	}
+	return nTotal;
+}
+
+uint32 C3DEngine::GetObjectsInBox(const AABB& bbox, IRenderNode** pObjects)
+{
+	PodArray<IRenderNode*> lstObjects;
+	CopyObjects(&bbox, &lstObjects);
+	if (pObjects && !lstObjects.IsEmpty())
+		memcpy(pObjects, &lstObjects[0], lstObjects.GetDataSize());
+	return lstObjects.Count();
+}
+
+uint32 C3DEngine::GetObjectsByFlags(uint dwFlags, IRenderNode** pObjects /* =0 */)
+{
+	PodArray<IRenderNode*> lstObjects;
+
+	if (Get3DEngine()->m_pObjectsTree)
+		Get3DEngine()->m_pObjectsTree->GetObjectsByFlags(dwFlags, lstObjects);
+
+	if (GetVisAreaManager())
+		GetVisAreaManager()->GetObjectsByFlags(dwFlags, lstObjects);
+
+	if (pObjects && !lstObjects.IsEmpty())
+		memcpy(pObjects, &lstObjects[0], lstObjects.GetDataSize());
+	return lstObjects.Count();
+}
+
+bool C3DEngine::QueryObjectTypeIndex(EERType objType, const AABB& box, PodArray<IRenderNode*>& lstObjects, uint64 dwFlags)
+{
+	if (!e_ObjectTypeIndex || m_bLevelLoadingInProgress || m_bInLoad || m_bInUnload || !m_pObjectsTree || (unsigned)objType >= eERType_TypesNum)
+		return false;
+
+	AUTO_LOCK(m_objectTypeIndexLock);
+
+	const float fCellSize = max(e_ObjectTypeIndexCellSize, 1.0f);
+	CObjectTypeIndex& index = m_objectTypeIndex[objType];
+	if (index.IsBuilt() && index.GetCellSize() != fCellSize)
+		InvalidateObjectTypeIndex();
+
+	if (!index.IsBuilt())
+	{
+		// The octree is only walked safely on the main thread, other threads use
+		// the regular query until the main thread built the index
+		if (gEnv->mMainThreadId != CryGetCurrentThreadId())
+			return false;
+
+		PodArray<IRenderNode*> lstAll;
+		CopyObjectsByType(objType, NULL, &lstAll);
+		index.Build(lstAll, fCellSize);
+		++m_nObjectTypeIndexBuilt;
+	}
+
+	index.Query(box, lstObjects, dwFlags);
+	return true;
+}
+
+void C3DEngine::UpdateObjectTypeIndex(IRenderNode* pEnt, EERType eType, const AABB& box)
+{
+	if (!m_nObjectTypeIndexBuilt)
+		return;
+
+	// Objects of a level being loaded or unloaded may be created and freed
+	// outside of the registration, so the indices are rebuilt afterwards
+	if (m_bLevelLoadingInProgress || m_bInLoad || m_bInUnload)
+	{
+		InvalidateObjectTypeIndex();
+		return;
 	}
 
-	CRY_ASSERT(pTempData);
-	if (!pTempData)
-		return nullptr;
+	AUTO_LOCK(m_objectTypeIndexLock);
+	m_objectTypeIndex[eType].Update(pEnt, box);
+}
 
-	if (!m_visibleNodesManager.SetLastSeenFrame(pTempData, passInfo))
-		pTempData = nullptr;
+void C3DEngine::RemoveFromObjectTypeIndex(IRenderNode* pEnt, EERType eType)
+{
+	if (!m_nObjectTypeIndexBuilt)
+		return;
 
-	return pTempData;
+	if (m_bLevelLoadingInProgress || m_bInLoad || m_bInUnload)
+	{
+		InvalidateObjectTypeIndex();
+		return;
+	}
+
+	AUTO_LOCK(m_objectTypeIndexLock);
+	m_objectTypeIndex[eType].Remove(pEnt);
 }
 
-void C3DEngine::CopyObjectsByType(EERType objType, const AABB* pBox, PodArray<IRenderNode*>* plstObjects, uint64 dwFlags)
+void C3DEngine::InvalidateObjectTypeIndex()
 {
-	GetObjectsByTypeGlobal(*plstObjects, objType, pBox, 0, dwFlags);
+	AUTO_LOCK(m_objectTypeIndexLock);
+	for (CObjectTypeIndex& index : m_objectTypeIndex)
+		index.Reset();
+	m_nObjectTypeIndexBuilt = 0;
+}
 
-	if (GetVisAreaManager())
-		GetVisAreaManager()->GetObjectsByType(*plstObjects, objType, pBox, 0, dwFlags);
+void CObjectTypeIndex::Build(const PodArray<IRenderNode*>& lstObjects, float fCellSize)
+{
+	Reset();
+	m_fCellSize = fCellSize;
+	m_bBuilt = true;
+	for (int i = 0; i < lstObjects.Count(); ++i)
+	{
+		if (m_nodes.find(lstObjects[i]) == m_nodes.end())
+			Add(lstObjects[i], lstObjects[i]->GetBBox());
+	}
 }
 
-void C3DEngine::CopyObjects(const AABB* pBox, PodArray<IRenderNode*>* plstObjects)
+void CObjectTypeIndex::Reset()
 {
-	m_pObjectsTree->GetObjects(*plstObjects, pBox);
+	stl::free_container(m_cells);
+	stl::free_container(m_nodes);
+	stl::free_container(m_large);
+	m_bBuilt = false;
+}
 
-	if (GetVisAreaManager())
-		GetVisAreaManager()->GetObjects(*plstObjects, pBox);
+CObjectTypeIndex::SCellRange CObjectTypeIndex::GetCellRange(const AABB& box) const
+{
+	const float fInvCellSize = 1.0f / m_fCellSize;
+	SCellRange range;
+	range.x0 = clamp_tpl((int)floorf(box.min.x * fInvCellSize), 0, 0xffff);
+	range.y0 = clamp_tpl((int)floorf(box.min.y * fInvCellSize), 0, 0xffff);
+	range.x1 = clamp_tpl((int)floorf(box.max.x * fInvCellSize), 0, 0xffff);
+	range.y1 = clamp_tpl((int)floorf(box.max.y * fInvCellSize), 0, 0xffff);
+	return range;
 }
 
-uint32 C3DEngine::GetObjectsByType(EERType objType, IRenderNode** pObjects)
+void CObjectTypeIndex::RemoveEntry(std::vector<SEntry>& entries, IRenderNode* pNode)
 {
-	PodArray<IRenderNode*> lstObjects;
-	CopyObjectsByType(objType, NULL, &lstObjects);
-	if (pObjects && !lstObjects.IsEmpty())
-		memcpy(pObjects, &lstObjects[0], lstObjects.GetDataSize());
-	return lstObjects.Count();
+	for (size_t i = 0, n = entries.size(); i < n; ++i)
+	{
+		if (entries[i].pNode == pNode)
+		{
+			entries[i] = entries.back();
+			entries.pop_back();
+			return;
+		}
+	}
 }
 
-uint32 C3DEngine::GetObjectsByTypeInBox(EERType objType, const AABB& bbox, IRenderNode** pObjects, uint64 dwFlags)
+void CObjectTypeIndex::Add(IRenderNode* pNode, const AABB& box)
 {
-	PodArray<IRenderNode*> lstObjects;
-	CopyObjectsByType(objType, &bbox, &lstObjects, dwFlags);
-	if (pObjects && !lstObjects.IsEmpty())
-		memcpy(pObjects, &lstObjects[0], lstObjects.GetDataSize());
-	return lstObjects.Count();
+	m_nodes[pNode] = box;
+
+	const SEntry entry = { pNode, box };
+	const SCellRange range = GetCellRange(box);
+	if (range.IsLarge())
+	{
+		m_large.push_back(entry);
+		return;
+	}
+
+	for (int y = range.y0; y <= range.y1; ++y)
+		for (int x = range.x0; x <= range.x1; ++x)
+			m_cells[CellKey(x, y)].push_back(entry);
 }
 
-uint32 C3DEngine::GetObjectsInBox(const AABB& bbox, IRenderNode** pObjects)
+void CObjectTypeIndex::Update(IRenderNode* pNode, const AABB& box)
 {
-	PodArray<IRenderNode*> lstObjects;
-	CopyObjects(&bbox, &lstObjects);
-	if (pObjects && !lstObjects.IsEmpty())
-		memcpy(pObjects, &lstObjects[0], lstObjects.GetDataSize());
-	return lstObjects.Count();
+	if (!m_bBuilt)
+		return;
+
+	auto it = m_nodes.find(pNode);
+	if (it != m_nodes.end())
+	{
+		if (IsEquivalent(it->second, box, 0.0f))
+			return;
+		Remove(pNode);
+	}
+
+	Add(pNode, box);
 }
 
-uint32 C3DEngine::GetObjectsByFlags(uint dwFlags, IRenderNode** pObjects /* =0 */)
+void CObjectTypeIndex::Remove(IRenderNode* pNode)
 {
-	PodArray<IRenderNode*> lstObjects;
+	auto it = m_nodes.find(pNode);
+	if (it == m_nodes.end())
+		return;
 
-	if (Get3DEngine()->m_pObjectsTree)
-		Get3DEngine()->m_pObjectsTree->GetObjectsByFlags(dwFlags, lstObjects);
+	const SCellRange range = GetCellRange(it->second);
+	m_nodes.erase(it);
 
-	if (GetVisAreaManager())
-		GetVisAreaManager()->GetObjectsByFlags(dwFlags, lstObjects);
+	if (range.IsLarge())
+	{
+		RemoveEntry(m_large, pNode);
+		return;
+	}
 
-	if (pObjects && !lstObjects.IsEmpty())
-		memcpy(pObjects, &lstObjects[0], lstObjects.GetDataSize());
-	return lstObjects.Count();
+	for (int y = range.y0; y <= range.y1; ++y)
+	{
+		for (int x = range.x0; x <= range.x1; ++x)
+		{
+			auto cell = m_cells.find(CellKey(x, y));
+			if (cell == m_cells.end())
+				continue;
+
+			RemoveEntry(cell->second, pNode);
+			if (cell->second.empty())
+				m_cells.erase(cell);
+		}
+	}
+}
+
+void CObjectTypeIndex::Query(const AABB& box, PodArray<IRenderNode*>& lstObjects, uint64 dwFlags) const
+{
+	for (const SEntry& entry : m_large)
+	{
+		if (Overlap::AABB_AABB(box, entry.box) && (dwFlags == ~0 || (entry.pNode->GetRndFlags() & dwFlags)))
+			lstObjects.Add(entry.pNode);
+	}
+
+	if (m_cells.empty())
+		return;
+
+	const SCellRange range = GetCellRange(box);
+	for (int y = range.y0; y <= range.y1; ++y)
+	{
+		for (int x = range.x0; x <= range.x1; ++x)
+		{
+			auto cell = m_cells.find(CellKey(x, y));
+			if (cell == m_cells.end())
+				continue;
+
+			for (const SEntry& entry : cell->second)
+			{
+				// Objects spanning several cells of the query are reported by the first of them only
+				const SCellRange entryRange = GetCellRange(entry.box);
+				if (max(entryRange.x0, range.x0) != x || max(entryRange.y0, range.y0) != y)
+					continue;
+
+				if (Overlap::AABB_AABB(box, entry.box) && (dwFlags == ~0 || (entry.pNode->GetRndFlags() & dwFlags)))
+					lstObjects.Add(entry.pNode);
+			}
+		}
+	}
 }
 
 void C3DEngine::OnObjectModified(IRenderNode* pRenderNode, IRenderNode::RenderFlagsType dwFlags)
@@ -5298,6 +6599,8 @@ void C3DEngine::ActivateObjectsLayer(uint16 nLayerId, bool bActivate, bool bPhys
 
 		if (m_pVisAreaManager)
 			m_pVisAreaManager->ActivateObjectsLayer(nLayerId, bActivate, bPhys, pHeap, m_arrObjectLayersActivity[nLayerId].objectsBox);
+
+		InvalidateObjectTypeIndex();
 	}
 
 	if (bStaticLights)
@@ -5449,46 +6752,242 @@ int C3DEngine::AddPrecachePoint(const Vec3& vPos, const Vec3& vDir, float fTimeO
 {
 	if (m_pObjManager)
 	{
-		if (m_pObjManager->m_vStreamPreCachePointDefs.size() >= CObjManager::MaxPrecachePoints)
+		// Added points start streaming right away, the scheduler only tracks their progress
+		SScheduledPrecachePoint point;
+		point.nId = m_pObjManager->m_nNextPrecachePointId++;
+		point.vDirection = vDir;
+		point.fTimeOut = fTimeOut;
+		point.fImportanceFactor = fImportanceFactor;
+		point.status.vPosition = vPos;
+		point.status.fArrivalTime = gEnv->pTimer->GetAsyncCurTime();
+		ActivatePrecachePoint(point);
+		m_scheduledPrecachePoints.push_back(point);
+
+		return point.nId;
+	}
+
+	return -1;
+}
+
+int C3DEngine::SchedulePrecachePoint(const Vec3& vPos, const Vec3& vDir, float fArrivalTime, float fTimeOut, float fImportanceFactor)
+{
+	if (m_pObjManager)
+	{
+		SScheduledPrecachePoint point;
+		point.nId = m_pObjManager->m_nNextPrecachePointId++;
+		point.vDirection = vDir;
+		point.fTimeOut = fTimeOut;
+		point.fImportanceFactor = fImportanceFactor;
+		point.status.vPosition = vPos;
+		point.status.fArrivalTime = gEnv->pTimer->GetAsyncCurTime() + max(fArrivalTime, 0.0f);
+		m_scheduledPrecachePoints.push_back(point);
+
+		return point.nId;
+	}
+
+	return -1;
+}
+
+bool C3DEngine::GetPrecachePointStatus(int id, SPrecachePointStatus& status) const
+{
+	for (const SScheduledPrecachePoint& point : m_scheduledPrecachePoints)
+	{
+		if (point.nId == id)
+		{
+			status = point.status;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Stream work still pending and memory held by streamed objects and textures
+static void GetPrecacheStreamingState(int& nPending, int64& nBytes)
+{
+	SStreamEngineOpenStats openStats;
+	gEnv->pSystem->GetStreamEngine()->GetStreamingOpenStatistics(openStats);
+
+	SObjectsStreamingStatus objectsStatus;
+	Cry3DEngineBase::Get3DEngine()->GetObjectsStreamingStatus(objectsStatus);
+
+	// dedicated servers and headless runs stream no textures
+	int64 nTextureBytes = 0;
+	if (gEnv->pRenderer)
+	{
+		STextureStreamingStats texturesStats(false);
+		gEnv->pRenderer->EF_Query(EFQ_GetTexStreamingInfo, texturesStats);
+		nTextureBytes = (int64)texturesStats.nStreamedTexturesSize;
+	}
+
+	nPending = openStats.nOpenRequestCount + objectsStatus.nInProgress;
+	nBytes = (int64)objectsStatus.nAllocatedBytes + nTextureBytes;
+}
+
+void C3DEngine::ActivatePrecachePoint(SScheduledPrecachePoint& point)
+{
+	if (m_pObjManager->m_vStreamPreCachePointDefs.size() >= CObjManager::MaxPrecachePoints)
+	{
+		// Scheduled points may be activated long after their id was assigned,
+		// so the point expiring first is evicted instead of the lowest id
+		size_t nOldestIdx = 0;
+		for (size_t i = 1, c = m_pObjManager->m_vStreamPreCachePointDefs.size(); i < c; ++i)
+		{
+			if (!nOldestIdx || m_pObjManager->m_vStreamPreCachePointDefs[i].expireTime < m_pObjManager->m_vStreamPreCachePointDefs[nOldestIdx].expireTime)
+				nOldestIdx = i;
+		}
+
+		assert(nOldestIdx > 0);
+
+		CryWarning(VALIDATOR_MODULE_3DENGINE, VALIDATOR_WARNING, "Precache points full - evicting the one expiring first (%f, %f, %f)",
+		           m_pObjManager->m_vStreamPreCacheCameras[nOldestIdx].vPosition.x,
+		           m_pObjManager->m_vStreamPreCacheCameras[nOldestIdx].vPosition.y,
+		           m_pObjManager->m_vStreamPreCacheCameras[nOldestIdx].vPosition.z);
+
+		m_pObjManager->m_vStreamPreCachePointDefs.DeleteFastUnsorted((int)nOldestIdx);
+		m_pObjManager->m_vStreamPreCacheCameras.DeleteFastUnsorted((int)nOldestIdx);
+	}
+
+	const float fNow = gEnv->pTimer->GetAsyncCurTime();
+
+	// Keep the point until the camera arrived and fTimeOut passed
+	SObjManPrecachePoint pp;
+	pp.nId = point.nId;
+	pp.expireTime = gEnv->pTimer->GetAsyncTime() + CTimeValue(max(point.status.fArrivalTime - fNow, 0.0f) + point.fTimeOut);
+	SObjManPrecacheCamera pc;
+	pc.vPosition = point.status.vPosition;
+	pc.bbox = AABB(point.status.vPosition, GetCVars()->e_StreamPredictionBoxRadius);
+	pc.vDirection = point.vDirection;
+	pc.fImportanceFactor = point.fImportanceFactor;
+	m_pObjManager->m_vStreamPreCachePointDefs.Add(pp);
+	m_pObjManager->m_vStreamPreCacheCameras.Add(pc);
+	//m_pObjManager->m_bCameraPrecacheOverridden = true;
+
+	int roundIds[MAX_STREAM_PREDICTION_ZONES] = { 0 };
+	GetPrecacheRoundIds(roundIds);
+	point.nStartRoundId = roundIds[0];
+	GetPrecacheStreamingState(point.nLastPending, point.nStartBytes);
+	point.nRoundPending = -1;
+	point.nDrained = 0;
+	point.status.fActivationTime = fNow;
+}
+
+void C3DEngine::UpdatePrecacheScheduler()
+{
+	if (m_scheduledPrecachePoints.empty() || !m_pObjManager)
+		return;
+
+	FUNCTION_PROFILER_3DENGINE;
+
+	const float fNow = gEnv->pTimer->GetAsyncCurTime();
+
+	int nPending;
+	int64 nBytes;
+	GetPrecacheStreamingState(nPending, nBytes);
+
+	int roundIds[MAX_STREAM_PREDICTION_ZONES] = { 0 };
+	GetPrecacheRoundIds(roundIds);
+
+	// Track the progress of the points streaming. Stream work is not tagged
+	// with the point requesting it, so a point is complete once the streaming
+	// priorities took it into account and as much work finished since as was
+	// pending then. Work queued later by others does not hold the point back.
+	// Streamed memory is engine wide, the active points share one growth
+	// figure, the one since the earliest of them started.
+	int nActive = 0;
+	int64 nActiveBytes = 0;
+	for (SScheduledPrecachePoint& point : m_scheduledPrecachePoints)
+	{
+		SPrecachePointStatus& status = point.status;
+		if (status.fActivationTime < 0.0f || status.fCompletionTime >= 0.0f)
+			continue;
+
+		status.nStreamedBytes = (int)min(max(nBytes - point.nStartBytes, (int64)0), (int64)INT_MAX);
+
+		const bool bRoundPassed = roundIds[0] > point.nStartRoundId + 1;
+		if (bRoundPassed)
+		{
+			if (point.nRoundPending < 0)
+				point.nRoundPending = nPending;
+			else
+				point.nDrained += max(point.nLastPending - nPending, 0);
+			status.fCompletion = point.nRoundPending > 0 ? min((float)point.nDrained / (float)point.nRoundPending, 1.0f) : 1.0f;
+		}
+		point.nLastPending = nPending;
+		const bool bDone = bRoundPassed && point.nDrained >= point.nRoundPending;
+
+		bool bExpired = true;
+		for (int i = 1; i < m_pObjManager->m_vStreamPreCachePointDefs.Count(); ++i)
 		{
-			size_t nOldestIdx = 0;
-			int nOldestId = INT_MAX;
-			for (size_t i = 1, c = m_pObjManager->m_vStreamPreCachePointDefs.size(); i < c; ++i)
+			if (m_pObjManager->m_vStreamPreCachePointDefs[i].nId == point.nId)
 			{
-				if (m_pObjManager->m_vStreamPreCachePointDefs[i].nId < nOldestId)
-				{
-					nOldestIdx = i;
-					nOldestId = m_pObjManager->m_vStreamPreCachePointDefs[i].nId;
-				}
+				bExpired = false;
+				break;
+			}
+		}
+
+		if (bDone || bExpired)
+		{
+			if (bDone)
+				status.fCompletion = 1.0f;
+			status.fCompletionTime = fNow;
+			status.bLate |= fNow > status.fArrivalTime || status.fCompletion < 1.0f;
+
+			if (e_PrecacheSchedulerLog)
+			{
+				CryLog("Precache point %d (%.1f, %.1f, %.1f): %.0f%% complete after %.2f s, %+.2f s to arrival, %.2f MB streamed%s",
+				       point.nId, status.vPosition.x, status.vPosition.y, status.vPosition.z, status.fCompletion * 100.0f,
+				       fNow - status.fActivationTime, status.fArrivalTime - fNow, status.nStreamedBytes / (1024.0f * 1024.0f),
+				       status.bLate ? " (late)" : "");
 			}
+			continue;
+		}
 
-			assert(nOldestIdx > 0);
+		if (fNow > status.fArrivalTime)
+			status.bLate = true;
+
+		++nActive;
+		nActiveBytes = max(nActiveBytes, (int64)status.nStreamedBytes);
+	}
 
-			CryWarning(VALIDATOR_MODULE_3DENGINE, VALIDATOR_WARNING, "Precache points full - evicting oldest (%f, %f, %f)",
-			           m_pObjManager->m_vStreamPreCacheCameras[nOldestIdx].vPosition.x,
-			           m_pObjManager->m_vStreamPreCacheCameras[nOldestIdx].vPosition.y,
-			           m_pObjManager->m_vStreamPreCacheCameras[nOldestIdx].vPosition.z);
+	// Hand queued points to streaming in order of arrival while the budgets
+	// allow it. Points whose arrival time came are started regardless.
+	SStremaingBandwidthData geometryBandwidth, textureBandwidth;
+	GetStreamingSubsystemData(eStreamTaskTypeGeometry, geometryBandwidth);
+	GetStreamingSubsystemData(eStreamTaskTypeTexture, textureBandwidth);
+	const float fBandwidth = geometryBandwidth.fBandwidthRequested + textureBandwidth.fBandwidthRequested;
+	const int64 nMemoryBudget = (int64)(e_PrecacheSchedulerMemory * 1024.0f * 1024.0f);
 
-			m_pObjManager->m_vStreamPreCachePointDefs.DeleteFastUnsorted((int)nOldestIdx);
-			m_pObjManager->m_vStreamPreCacheCameras.DeleteFastUnsorted((int)nOldestIdx);
+	for (;; )
+	{
+		SScheduledPrecachePoint* pNext = nullptr;
+		for (SScheduledPrecachePoint& point : m_scheduledPrecachePoints)
+		{
+			if (point.status.fActivationTime >= 0.0f || fNow < point.status.fArrivalTime - e_PrecacheSchedulerLeadTime)
+				continue;
+			if (!pNext || point.status.fArrivalTime < pNext->status.fArrivalTime ||
+			    (point.status.fArrivalTime == pNext->status.fArrivalTime && point.fImportanceFactor > pNext->fImportanceFactor))
+				pNext = &point;
 		}
+		if (!pNext)
+			break;
 
-		SObjManPrecachePoint pp;
-		pp.nId = m_pObjManager->m_nNextPrecachePointId++;
-		pp.expireTime = gEnv->pTimer->GetAsyncTime() + CTimeValue(fTimeOut);
-		SObjManPrecacheCamera pc;
-		pc.vPosition = vPos;
-		pc.bbox = AABB(vPos, GetCVars()->e_StreamPredictionBoxRadius);
-		pc.vDirection = vDir;
-		pc.fImportanceFactor = fImportanceFactor;
-		m_pObjManager->m_vStreamPreCachePointDefs.Add(pp);
-		m_pObjManager->m_vStreamPreCacheCameras.Add(pc);
-		//m_pObjManager->m_bCameraPrecacheOverridden = true;
+		const bool bInBudget =
+		  nActive < e_PrecacheSchedulerMaxActive &&
+		  (e_PrecacheSchedulerBandwidth <= 0.0f || fBandwidth < e_PrecacheSchedulerBandwidth) &&
+		  (nMemoryBudget <= 0 || nActiveBytes < nMemoryBudget);
+		if (!bInBudget && fNow < pNext->status.fArrivalTime)
+			break;
 
-		return pp.nId;
+		ActivatePrecachePoint(*pNext);
+		++nActive;
 	}
 
-	return -1;
+	// Finished points stay queryable for a while
+	const float fKeepTime = 10.0f;
+	m_scheduledPrecachePoints.erase(std::remove_if(m_scheduledPrecachePoints.begin(), m_scheduledPrecachePoints.end(), [fNow, fKeepTime](const SScheduledPrecachePoint& point)
+	{
+		return point.status.fCompletionTime >= 0.0f && fNow - point.status.fCompletionTime > fKeepTime;
+	}), m_scheduledPrecachePoints.end());
 }
 
 void C3DEngine::ClearPrecachePoint(int id)
@@ -5505,6 +7004,15 @@ void C3DEngine::ClearPrecachePoint(int id)
 			}
 		}
 	}
+
+	for (size_t i = 0; i < m_scheduledPrecachePoints.size(); ++i)
+	{
+		if (m_scheduledPrecachePoints[i].nId == id)
+		{
+			m_scheduledPrecachePoints.erase(m_scheduledPrecachePoints.begin() + i);
+			break;
+		}
+	}
 }
 
 void C3DEngine::ClearAllPrecachePoints()
@@ -5514,6 +7022,8 @@ void C3DEngine::ClearAllPrecachePoints()
 		m_pObjManager->m_vStreamPreCachePointDefs.resize(1);
 		m_pObjManager->m_vStreamPreCacheCameras.resize(1);
 	}
+
+	m_scheduledPrecachePoints.clear();
 }
 
 void C3DEngine::GetPrecacheRoundIds(int pRoundIds[MAX_STREAM_PREDICTION_ZONES])
@@ -5737,6 +7247,45 @@ void C3DEngine::UpdateShaderItems()
 	if (GetMatMan())
 		GetMatMan()->UpdateShaderItems();
 }
+///////////////////////////////////////////////////////////////////////////////
+// Engine state snapshot layout:
+//   uint32  tag, kInternalStateTag
+//   uint8   flags, EInternalStateFlags
+//   uint8   terrain mask, uint32 object mask, 6 x float area box
+//   uint32  terrain and object compiled data size
+//   uint32  crc of the uncompressed compiled data
+//   uint32  crc of the base snapshot, only for eInternalState_Delta
+//   uint32  size of the stored payload and the payload itself
+// A delta payload is the compiled data XOR the base snapshot, the runs of zeros
+// left by unchanged nodes are what make it compress well.
+static const uint32 kInternalStateTag = 0x53533345; // 'E3SS'
+
+enum EInternalStateFlags
+{
+	eInternalState_Compressed = BIT(0),
+	eInternalState_Delta      = BIT(1),
+};
+
+static void XorInternalState(std::vector<uint8>& data, const std::vector<uint8>& base)
+{
+	assert(data.size() == base.size());
+	const size_t nSize = data.size();
+	const size_t nWords = nSize / sizeof(uint32);
+	uint32* pData = alias_cast<uint32*>(&data[0]);
+	const uint32* pBase = alias_cast<const uint32*>(&base[0]);
+	for (size_t i = 0; i < nWords; ++i)
+		pData[i] ^= pBase[i];
+	for (size_t i = nWords * sizeof(uint32); i < nSize; ++i)
+		data[i] ^= base[i];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void C3DEngine::ResetInternalStateBase()
+{
+	stl::free_container(m_internalStateSaveBase.data);
+	stl::free_container(m_internalStateLoadBase.data);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void C3DEngine::SaveInternalState(struct IDataWriteStream& writer, const AABB& filterArea, const bool bTerrain, const uint32 objectMask)
 {
@@ -5791,7 +7340,55 @@ void C3DEngine::SaveInternalState(struct IDataWriteStream& writer, const AABB& f
 				}
 			}
 
+			const uint32 dataCrc = CCrc32::Compute(&outputData[0], outputData.size());
+
+			// delta against the previous snapshot if the receiver can rebuild it
+			SInternalStateBase& base = m_internalStateSaveBase;
+			const bool bDelta = e_StateSnapshotDelta && base.pObjectsTree == m_pObjectsTree && base.Matches(terrainMask, objectMask, info.areaBox, terrainCompiledDataSize, outputData.size());
+			const uint32 baseCrc = base.nCrc;
+
+			std::vector<uint8> payload;
+			if (bDelta)
+			{
+				payload = outputData;
+				XorInternalState(payload, base.data);
+			}
+
+			if (e_StateSnapshotDelta)
+			{
+				base.data.swap(outputData);
+				base.areaBox = info.areaBox;
+				base.nObjectMask = objectMask;
+				base.nTerrainSize = terrainCompiledDataSize;
+				base.nTerrainMask = terrainMask;
+				base.nCrc = dataCrc;
+				base.pObjectsTree = m_pObjectsTree;
+			}
+			else
+			{
+				stl::free_container(base.data);
+			}
+
+			std::vector<uint8>& source = bDelta ? payload : (e_StateSnapshotDelta ? base.data : outputData);
+
+			// keep the compressed data only if it is actually smaller
+			uint8 flags = bDelta ? eInternalState_Delta : 0;
+			std::vector<uint8> compressed;
+			if (e_StateSnapshotCompression > 0)
+			{
+				size_t compressedSize = source.size();
+				compressed.resize(compressedSize);
+				if (GetSystem()->CompressDataBlock(&source[0], source.size(), &compressed[0], compressedSize, e_StateSnapshotCompression) && compressedSize < source.size())
+				{
+					compressed.resize(compressedSize);
+					flags |= eInternalState_Compressed;
+				}
+			}
+			const std::vector<uint8>& stored = (flags & eInternalState_Compressed) ? compressed : source;
+
 			// store the data
+			writer << kInternalStateTag;
+			writer << flags;
 			writer << terrainMask;
 			writer << objectMask;
 			writer << info.areaBox.min.x;
@@ -5802,7 +7399,10 @@ void C3DEngine::SaveInternalState(struct IDataWriteStream& writer, const AABB& f
 			writer << info.areaBox.max.z;
 			writer << terrainCompiledDataSize;
 			writer << objectCompiledDataSize;
-			writer << outputData;
+			writer << dataCrc;
+			if (bDelta)
+				writer << baseCrc;
+			writer << stored;
 		}
 	}
 }
@@ -5810,6 +7410,14 @@ void C3DEngine::SaveInternalState(struct IDataWriteStream& writer, const AABB& f
 ///////////////////////////////////////////////////////////////////////////////
 void C3DEngine::LoadInternalState(struct IDataReadStream& reader, const uint8* pVisibleLayersMask, const uint16* pLayerIdTranslation)
 {
+	const uint32 tag = reader.ReadUint32();
+	if (tag != kInternalStateTag)
+	{
+		Warning("C3DEngine::LoadInternalState: unknown snapshot format");
+		return;
+	}
+	const uint8 flags = reader.ReadUint8();
+
 	SHotUpdateInfo info;
 	info.nHeigtmap = reader.ReadUint8();
 	info.nObjTypeMask = reader.ReadUint32();
@@ -5824,6 +7432,43 @@ void C3DEngine::LoadInternalState(struct IDataReadStream& reader, const uint8* p
 
 	const uint32 terrainDataSize = reader.ReadUint32();
 	const uint32 objectDataSize = reader.ReadUint32();
+	const uint32 dataCrc = reader.ReadUint32();
+	const uint32 baseCrc = (flags & eInternalState_Delta) ? reader.ReadUint32() : 0;
+
+	// load data
+	std::vector<uint8> binaryData;
+	reader << binaryData;
+
+	const size_t dataSize = terrainDataSize + objectDataSize;
+	if (flags & eInternalState_Compressed)
+	{
+		std::vector<uint8> compressed;
+		compressed.swap(binaryData);
+		binaryData.resize(dataSize);
+		size_t uncompressedSize = dataSize;
+		if (!GetSystem()->DecompressDataBlock(&compressed[0], compressed.size(), &binaryData[0], uncompressedSize) || uncompressedSize != dataSize)
+		{
+			Warning("C3DEngine::LoadInternalState: failed to decompress snapshot");
+			return;
+		}
+	}
+
+	SInternalStateBase& base = m_internalStateLoadBase;
+	if (flags & eInternalState_Delta)
+	{
+		if (base.nCrc != baseCrc || base.pObjectsTree != m_pObjectsTree || !base.Matches((uint8)info.nHeigtmap, info.nObjTypeMask, info.areaBox, terrainDataSize, dataSize))
+		{
+			Warning("C3DEngine::LoadInternalState: delta snapshot does not match the last loaded state, run e_StateSnapshotFull on the sender to get a full snapshot");
+			return;
+		}
+		XorInternalState(binaryData, base.data);
+	}
+
+	if (binaryData.size() != dataSize || CCrc32::Compute(&binaryData[0], dataSize) != dataCrc)
+	{
+		Warning("C3DEngine::LoadInternalState: snapshot data is corrupt");
+		return;
+	}
 
 	// keep the CGF resident for the duration of the update
 	gEnv->p3DEngine->LockCGFResources();
@@ -5834,10 +7479,6 @@ void C3DEngine::LoadInternalState(struct IDataReadStream& reader, const uint8* p
 	std::vector<struct IStatObj*>* pStatObjTable = NULL;
 	std::vector<struct IMaterial*>* pMatTable = NULL;
 
-	// load data
-	std::vector<uint8> binaryData;
-	reader << binaryData;
-
 	ITerrain* pTerrain = gEnv->p3DEngine->GetITerrain();
 	if (NULL != pTerrain)
 	{
@@ -5870,6 +7511,18 @@ void C3DEngine::LoadInternalState(struct IDataReadStream& reader, const uint8* p
 	// release the lock on the resources
 	// this will also release all unused CGF resources
 	gEnv->p3DEngine->UnlockCGFResources();
+
+	// the compiled data replaced objects without registering them
+	InvalidateObjectTypeIndex();
+
+	// the next delta is relative to this state
+	base.data.swap(binaryData);
+	base.areaBox = info.areaBox;
+	base.nObjectMask = info.nObjTypeMask;
+	base.nTerrainSize = terrainDataSize;
+	base.nTerrainMask = (uint8)info.nHeigtmap;
+	base.nCrc = dataCrc;
+	base.pObjectsTree = m_pObjectsTree;
 }
 
 void C3DEngine::OnCameraTeleport()
@@ -6564,10 +8217,21 @@ int C3DEngine::GetTerrainSize()
 }
 #include "ParticleEmitter.h"
 
+// Adds the time of its scope to the octree update stats
+struct SOctreeUpdateTimer
+{
+	explicit SOctreeUpdateTimer(int64& ticks) : m_ticks(ticks), m_start(CryGetTicks()) {}
+	~SOctreeUpdateTimer() { m_ticks += CryGetTicks() - m_start; }
+
+	int64& m_ticks;
+	int64  m_start;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 void C3DEngine::AsyncOctreeUpdate(IRenderNode* pEnt, uint32 nFrameID, bool bUnRegisterOnly)
 {
 	FUNCTION_PROFILER_3DENGINE;
+	SOctreeUpdateTimer timer(m_octreeUpdateStats.nTicks);
 
 #ifdef _DEBUG   // crash test basically
 	const char* szClass = pEnt->GetEntityClassName();
@@ -6578,6 +8242,7 @@ void C3DEngine::AsyncOctreeUpdate(IRenderNode* pEnt, uint32 nFrameID, bool bUnRe
 
 	IF (bUnRegisterOnly, 0)
 	{
+		++m_octreeUpdateStats.nUnregisters;
 		UnRegisterEntityImpl(pEnt);
 		return;
 	}
@@ -6585,6 +8250,7 @@ void C3DEngine::AsyncOctreeUpdate(IRenderNode* pEnt, uint32 nFrameID, bool bUnRe
 	const AABB aabb = pEnt->GetBBox();
 	float fObjRadiusSqr = aabb.GetRadiusSqr();
 	EERType eERType = pEnt->GetRenderNodeType();
+	++m_octreeUpdateStats.arrTypeUpdates[eERType];
 
 #ifdef SUPP_HMAP_OCCL
 	if (SRenderNodeTempData* pTempData = pEnt->m_pTempData)
@@ -6609,7 +8275,11 @@ void C3DEngine::AsyncOctreeUpdate(IRenderNode* pEnt, uint32 nFrameID, bool bUnRe
 
 			IVisArea* pVisArea = pEnt->GetEntityVisArea();
 			if (pVisArea && pVisArea->IsPointInsideVisArea(vEntCenter))
+			{
+				++m_octreeUpdateStats.nFastPath;
+				UpdateObjectTypeIndex(pEnt, eERType, aabb);
 				return; // same visarea
+			}
 
 			IVisArea* pVisAreaFromPos = (!m_pVisAreaManager || dwRndFlags & ERF_OUTDOORONLY) ? NULL : GetVisAreaManager()->GetVisAreaFromPos(vEntCenter);
 			if (pVisAreaFromPos == pVisArea)
@@ -6618,6 +8288,8 @@ void C3DEngine::AsyncOctreeUpdate(IRenderNode* pEnt, uint32 nFrameID, bool bUnRe
 				if (GetClipVolumeManager()->IsClipVolumeRequired(pEnt))
 					GetClipVolumeManager()->UpdateEntityClipVolume(vEntCenter, pEnt);
 
+				++m_octreeUpdateStats.nFastPath;
+				UpdateObjectTypeIndex(pEnt, eERType, aabb);
 				return; // same visarea or same outdoor
 			}
 		}
@@ -6698,6 +8370,7 @@ void C3DEngine::AsyncOctreeUpdate(IRenderNode* pEnt, uint32 nFrameID, bool bUnRe
 	}
 
 	//////////////////////////////////////////////////////////////////////////
+	++m_octreeUpdateStats.nInserts;
 	if (pEnt->GetRndFlags() & ERF_OUTDOORONLY || !(m_pVisAreaManager && m_pVisAreaManager->SetEntityArea(pEnt, aabb, fObjRadiusSqr)))
 	{
 		if (m_pObjectsTree)
@@ -6705,6 +8378,8 @@ void C3DEngine::AsyncOctreeUpdate(IRenderNode* pEnt, uint32 nFrameID, bool bUnRe
 			m_pObjectsTree->InsertObject(pEnt, aabb, fObjRadiusSqr, aabb.GetCenter());
 		}
 	}
+
+	UpdateObjectTypeIndex(pEnt, eERType, aabb);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -6727,6 +8402,9 @@ void C3DEngine::UpdateObjectsLayerAABB(IRenderNode* pEnt)
 ///////////////////////////////////////////////////////////////////////////////
 bool C3DEngine::UnRegisterEntityImpl(IRenderNode* pEnt)
 {
+	// a queued octree update must not register the object again
+	m_octreeUpdateQueued.erase(pEnt);
+
 	// make sure we don't try to update the streaming priority if an object
 	// was added and removed in the same frame
 	int nElementID = m_deferredRenderProxyStreamingPriorityUpdates.Find(pEnt);
@@ -6750,6 +8428,8 @@ bool C3DEngine::UnRegisterEntityImpl(IRenderNode* pEnt)
 	if (pEnt->GetParent())
 		bFound = ((COctreeNode*)pEnt->GetParent())->DeleteObject(pEnt);
 
+	RemoveFromObjectTypeIndex(pEnt, eRenderNodeType);
+
 	if (pEnt->GetRndFlags() & ERF_RENDER_ALWAYS || (eRenderNodeType == eERType_Light) || (eRenderNodeType == eERType_FogVolume))
 	{
 		m_lstAlwaysVisible.Delete(pEnt);
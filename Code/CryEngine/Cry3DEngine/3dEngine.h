@@ -11,6 +11,7 @@
 #include <CryThreading/IJobManager.h>
 #include <CryCore/Containers/CryListenerSet.h>
 #include <CryThreading/CryThreadSafePushContainer.h>
+#include <unordered_set>
 
 #ifdef DrawText
 	#undef DrawText
@@ -110,6 +111,159 @@ struct SOptimizedOutdoorWindArea
 	IPhysicalEntity* pArea;// Physical area
 };
 
+// Uniform 2d grid over a list of wind areas. Every cell references the areas
+// overlapping it, in the order of the list.
+struct SWindAreaGrid
+{
+	int                 x0, y0;    // Grid origin
+	int                 cellSize;  // Cell extent in meters
+	int                 dimX, dimY;
+	std::vector<uint32> cellStart; // dimX * dimY + 1 offsets into areaIndices
+	std::vector<uint32> areaIndices;
+
+	SWindAreaGrid() : x0(0), y0(0), cellSize(1), dimX(0), dimY(0) {}
+
+	void Build(const std::vector<SOptimizedOutdoorWindArea>& areas);
+
+	// Range of the indices of the areas that may contain the point, empty outside of the grid
+	void Query(int px, int py, const uint32*& pBegin, const uint32*& pEnd) const
+	{
+		pBegin = pEnd = nullptr;
+		if (px < x0 || py < y0)
+			return;
+		const int cx = (px - x0) / cellSize;
+		const int cy = (py - y0) / cellSize;
+		if (cx >= dimX || cy >= dimY)
+			return;
+		const int cell = cx + cy * dimX;
+		pBegin = areaIndices.data() + cellStart[cell];
+		pEnd = areaIndices.data() + cellStart[cell + 1];
+	}
+};
+
+// Forced wind areas addressed by handles. The areas are kept densely packed for
+// rasterization and removed by swapping in the last one. Adds and removes are
+// queued and applied by Flush() while no wind grid job reads the areas.
+class CForcedWindAreaRegistry
+{
+public:
+	typedef uint32 THandle;
+	static const THandle InvalidHandle = 0;
+
+	THandle Add(const SOptimizedOutdoorWindArea& area);
+	void    Remove(THandle handle);
+	bool    IsValid(THandle handle) const;
+
+	void    Flush();
+	// Fades the center wind of all areas out and removes the faded ones
+	void    Fade(float fElapsedTime);
+	void    Clear();
+
+	std::vector<SOptimizedOutdoorWindArea>* GetAreas() { return &m_areas; }
+	size_t                                  GetCount() const { return m_areas.size(); }
+
+private:
+	typedef std::pair<THandle, SOptimizedOutdoorWindArea> TPendingAdd;
+
+	static const uint32 PendingIndex = ~0u;
+	static const uint32 FreeIndex = ~0u - 1;
+
+	struct SSlot
+	{
+		uint32 denseIndex; // Index into m_areas, PendingIndex or FreeIndex
+		uint16 generation;
+	};
+
+	static uint32 SlotOf(THandle handle)       { return handle & 0xffff; }
+	static uint16 GenerationOf(THandle handle) { return (uint16)(handle >> 16); }
+
+	void          RemoveAt(uint32 denseIndex);
+	void          FreeSlot(uint32 slot);
+
+	std::vector<SOptimizedOutdoorWindArea> m_areas;
+	std::vector<THandle>                   m_handles; // Handle of every area in m_areas
+	std::vector<SSlot>                     m_slots;
+	std::vector<uint32>                    m_freeSlots;
+	std::vector<TPendingAdd>               m_pendingAdds;
+	std::vector<THandle>                   m_pendingRemoves;
+};
+
+// Registered render nodes of one type on a 2D grid, for box queries that
+// would otherwise walk every octree node. Objects are stored in all cells
+// they overlap, objects overlapping too many cells go to a separate list.
+class CObjectTypeIndex
+{
+public:
+	CObjectTypeIndex() : m_fCellSize(1.0f), m_bBuilt(false) {}
+
+	void   Build(const PodArray<IRenderNode*>& lstObjects, float fCellSize);
+	void   Reset();
+	bool   IsBuilt() const { return m_bBuilt; }
+	float  GetCellSize() const { return m_fCellSize; }
+	size_t GetCount() const { return m_nodes.size(); }
+
+	// Adds the node or moves it to the new box
+	void   Update(IRenderNode* pNode, const AABB& box);
+	void   Remove(IRenderNode* pNode);
+	void   Query(const AABB& box, PodArray<IRenderNode*>& lstObjects, uint64 dwFlags) const;
+
+private:
+	struct SEntry
+	{
+		IRenderNode* pNode;
+		AABB         box;
+	};
+	struct SCellRange
+	{
+		int x0, y0, x1, y1;
+		bool IsLarge() const { return (x1 - x0 + 1) * (y1 - y0 + 1) > MaxCellsPerObject; }
+	};
+
+	static const int MaxCellsPerObject = 64;
+
+	SCellRange    GetCellRange(const AABB& box) const;
+	static uint32 CellKey(int x, int y) { return (uint32)x | ((uint32)y << 16); }
+	static void   RemoveEntry(std::vector<SEntry>& entries, IRenderNode* pNode);
+	void          Add(IRenderNode* pNode, const AABB& box);
+
+	std::unordered_map<uint32, std::vector<SEntry>> m_cells;
+	std::unordered_map<IRenderNode*, AABB>            m_nodes;
+	std::vector<SEntry>                               m_large;
+	float m_fCellSize;
+	bool  m_bBuilt;
+};
+
+// Progress of a precache point handed to the precache scheduler
+struct SPrecachePointStatus
+{
+	Vec3  vPosition;
+	float fArrivalTime;    // Async time the camera is expected at the point
+	float fActivationTime; // Async time the point was handed to streaming, -1 while queued
+	float fCompletionTime; // Async time its streaming settled or it expired, -1 while pending
+	float fCompletion;     // 0..1 of the streaming work queued since activation that finished
+	int   nStreamedBytes;  // Engine wide growth of streamed object and texture memory while the point was active
+	bool  bLate;           // Not complete at fArrivalTime
+
+	SPrecachePointStatus() : vPosition(0, 0, 0), fArrivalTime(0), fActivationTime(-1), fCompletionTime(-1), fCompletion(0), nStreamedBytes(0), bLate(false) {}
+};
+
+// Post effect parameter name resolved into a renderer handle on first use.
+// Failed lookups are retried, the post effects may not be registered yet.
+struct SPostEffectParamHandle
+{
+	explicit SPostEffectParamHandle(const char* szParamName) : szName(szParamName), nHandle(-1) {}
+
+	int32 Get() const
+	{
+		if (nHandle < 0 && gEnv->pRenderer)
+			nHandle = gEnv->pRenderer->EF_GetPostEffectParamHandle(szName);
+		return nHandle;
+	}
+
+	const char*   szName;
+	mutable int32 nHandle;
+};
+
 struct DLightAmount
 {
 	SRenderLight* pLight;
@@ -385,6 +539,8 @@ public:
 
 	void              AsyncOctreeUpdate(IRenderNode* pEnt, uint32 nFrameID, bool bUnRegisterOnly);
 	bool              UnRegisterEntityImpl(IRenderNode* pEnt);
+	void              ProcessOctreeUpdateQueue();
+	bool              IsOctreeUpdateBudgetExhausted() const;
 	virtual void      UpdateObjectsLayerAABB(IRenderNode* pEnt);
 
 	// Fast option - use if just ocean height required
@@ -476,6 +632,10 @@ public:
 	virtual void                           ClearPrecachePoint(int id);
 	virtual void                           ClearAllPrecachePoints();
 	virtual void                           GetPrecacheRoundIds(int pRoundIds[MAX_STREAM_PREDICTION_ZONES]);
+	//! Queues a precache point the camera is expected to reach in fArrivalTime seconds. Points are handed to
+	//! streaming in order of arrival within the e_PrecacheScheduler budgets. Returns an id for ClearPrecachePoint.
+	int                                    SchedulePrecachePoint(const Vec3& vPos, const Vec3& vDir, float fArrivalTime, float fTimeOut = 3.f, float fImportanceFactor = 1.0f);
+	bool                                   GetPrecachePointStatus(int id, SPrecachePointStatus& status) const;
 
 	virtual void                           TraceFogVolumes(const Vec3& worldPos, ColorF& fogVolumeContrib, const SRenderingPassInfo& passInfo);
 
@@ -515,16 +675,27 @@ public:
 	virtual void                           SetWind(const Vec3& vWind);
 	virtual Vec3                           GetWind(const AABB& box, bool bIndoors) const;
 	virtual void                           AddForcedWindArea(const Vec3& vPos, float fAmountOfForce, float fRadius);
+	//! Same as AddForcedWindArea, returns a handle the area can be removed with before it faded out.
+	CForcedWindAreaRegistry::THandle       AddForcedWindAreaHandle(const Vec3& vPos, float fAmountOfForce, float fRadius);
+	void                                   RemoveForcedWindArea(CForcedWindAreaRegistry::THandle handle);
 
 	void                                   StartWindGridJob(const Vec3& vPos);
 	void                                   FinishWindGridJob();
-	void                                   UpdateWindGridJobEntry(Vec3 vPos);
-	void                                   UpdateWindGridArea(SWindGrid& rWindGrid, const SOptimizedOutdoorWindArea& windArea, const AABB& windBox);
-	void                                   RasterWindAreas(std::vector<SOptimizedOutdoorWindArea>* pWindAreas, float fElapsedTime);
-	void                                   RasterGlobalWind(const Vec3& vGlobalWind, float fElapsedTime, bool bReset);
+	void                                   UpdateWindGridJobEntry(int nRowBegin, int nRowEnd);
+	void                                   UpdateWindGridArea(SWindGrid& rWindGrid, const SOptimizedOutdoorWindArea& windArea, const AABB& windBox, int nRowBegin, int nRowEnd);
+	void                                   RasterWindAreas(std::vector<SOptimizedOutdoorWindArea>* pWindAreas, const uint8* pSkipAreas, float fElapsedTime, int nRowBegin, int nRowEnd);
+	void                                   UpdateWindTileStates(const SWindGrid& rWindGrid);
+	bool                                   GetWindAreaTiles(const SWindGrid& rWindGrid, const Vec2* point, Vec2i& vTileMin, Vec2i& vTileMax) const;
+	void                                   MarkWindTilesDirty(const SWindGrid& rWindGrid, const Vec2* point, float fResidual);
+	bool                                   AreWindTilesSettled(const SWindGrid& rWindGrid, const Vec2* point, int nBufferBit) const;
+	void                                   RasterGlobalWind(const Vec3& vGlobalWind, float fElapsedTime, bool bReset, int nRowBegin, int nRowEnd);
 
 	virtual Vec3                           GetGlobalWind(bool bIndoors) const;
 	virtual bool                           SampleWind(Vec3* pSamples, int nSamples, const AABB& volume, bool bIndoors) const;
+	//! Samples the wind at the positions in pSamples by bilinear interpolation of the last submitted wind grid.
+	//! Cheaper than SampleWind for many samples, at the resolution of the grid. Falls back to SampleWind
+	//! for samples outside of the grid, indoor samples and while no grid has been computed.
+	bool                                   SampleWindGrid(Vec3* pSamples, int nSamples, const AABB& volume, bool bIndoors) const;
 	virtual IBreezeGenerator*              GetBreezeGenerator() const;
 	virtual IVisArea*                      GetVisAreaFromPos(const Vec3& vPos) const;
 	virtual bool                           IntersectsVisAreas(const AABB& box, void** pNodeCache = 0) const;
@@ -588,6 +759,13 @@ public:
 	virtual void   GetPostEffectParamVec4(const char* pParam, Vec4& pValue) const;
 	virtual void   GetPostEffectParamString(const char* pParam, const char*& pszArg) const;
 
+	// Handle based access, resolve the name once and reuse the handle to skip per call name lookups
+	virtual int32  GetPostEffectParamHandle(const char* pParam) const;
+	virtual void   SetPostEffectParamByHandle(int32 nHandle, float fValue, bool bForceValue = false) const;
+	virtual void   SetPostEffectParamVec4ByHandle(int32 nHandle, const Vec4& pValue, bool bForceValue = false) const;
+	virtual void   GetPostEffectParamByHandle(int32 nHandle, float& fValue) const;
+	virtual void   GetPostEffectParamVec4ByHandle(int32 nHandle, Vec4& pValue) const;
+
 	virtual int32  GetPostEffectID(const char* pPostEffectName);
 
 	virtual void   ResetPostEffects(bool bOnSpecChange = false) const;
@@ -605,6 +783,9 @@ public:
 	virtual uint32 GetObjectsByTypeInBox(EERType objType, const AABB& bbox, IRenderNode** pObjects, uint64 dwFlags = ~0);
 	virtual uint32 GetObjectsInBox(const AABB& bbox, IRenderNode** pObjects = 0);
 	virtual uint32 GetObjectsByFlags(uint dwFlags, IRenderNode** pObjects = 0);
+	// Queries several boxes at once, the objects of each box follow the ones of the previous box
+	// and pCounts receives the number per box. Returns the total, pObjects may be null to size it.
+	uint32         GetObjectsByTypeInBoxes(EERType objType, const AABB* pBoxes, uint32 nBoxes, IRenderNode** pObjects, uint32* pCounts, uint64 dwFlags = ~0);
 	virtual void   OnObjectModified(IRenderNode* pRenderNode, IRenderNode::RenderFlagsType dwFlags);
 
 	virtual void   ActivateObjectsLayer(uint16 nLayerId, bool bActivate, bool bPhys, bool bObjects, bool bStaticLights, const char* pLayerName, IGeneralMemoryHeap* pHeap = NULL, bool bCheckLayerActivation = true);
@@ -635,6 +816,9 @@ public:
 	virtual void EndOcclusion();
 #ifndef _RELEASE
 	void         ProcessStreamingLatencyTest(const CCamera& camIn, CCamera& camOut, const SRenderingPassInfo& passInfo);
+	bool         StartStreamingLatencyRun(const char* szPositionsFile, const char* szReportFile);
+	void         ProcessStreamingLatencyRun(CCamera& camOut, const SRenderingPassInfo& passInfo);
+	void         WriteStreamingLatencyRunReport();
 #endif
 
 	void ScreenShotHighRes(CStitchedImage* pStitchedImage, const int nRenderFlags, const SRenderingPassInfo& passInfo, uint32 SliceCount, f32 fTransitionSize);
@@ -747,9 +931,48 @@ public:
 	float                 m_volFogFinalDensityClamp;
 
 	int                   m_nCurWind;         // Current wind-field buffer Id
+	int                   m_nSubmittedWind;   // Wind-field buffer last submitted to the renderer, -1 if none
 	SWindGrid             m_WindGrid[2];      // Wind field double-buffered
 	Vec2*                 m_pWindField;       // Old wind speed values for interpolation
 	int*                  m_pWindAreaFrames;  // Area frames for rest updates
+
+	// State of a tile of the wind grid for incremental updates
+	struct SWindTile
+	{
+		Vec2  vField;        // Wind of all cells of the tile if bUniform is set
+		float fResidual;     // Upper bound of the distance of the cells to the wind they converge to
+		int   nTouchedFrame; // Last frame a wind area was rasterized into the tile
+		uint8 bUniform;      // All cells hold vField
+		uint8 nSettledMask;  // Bit per wind grid buffer already holding the settled cells
+
+		SWindTile() : vField(0, 0), fResidual(0.0f), nTouchedFrame(-1), bUniform(1), nSettledMask(0) {}
+	};
+	std::vector<SWindTile> m_windTiles;
+	// Wind area as it was last rasterized, to find the areas changed since
+	struct SWindAreaState
+	{
+		Vec2 point[5];
+		Vec3 windSpeed[5];
+		int  nUpdate; // Last wind grid update the area was listed in
+	};
+	std::unordered_map<IPhysicalEntity*, SWindAreaState> m_windAreaStates;
+	std::vector<uint8>     m_windAreaSkip;           // Per outdoor area, set when all its tiles settled
+	Vec3                   m_vWindTilesCentr;        // Grid center the tile states belong to
+	Vec3                   m_vWindTilesGlobalWind;   // Global wind the tile states belong to
+	float                  m_fWindTilesAreaStrength; // Area strength the tile states belong to
+	int                    m_nWindTilesUpdate;
+	// Parameters shared by all wind grid jobs of one update
+	struct SWindGridUpdate
+	{
+		Vec3  vGlobalWind;
+		float fElapsedTime;
+		float fFrameTime;
+		int   nFrameId;
+		bool  bReset;
+
+		SWindGridUpdate() : vGlobalWind(0, 0, 0), fElapsedTime(0.0f), fFrameTime(0.0f), nFrameId(0), bReset(false) {}
+	};
+	SWindGridUpdate        m_windGridUpdate;
 	Vec3                  m_vWindFieldCamera; // Wind field camera for interpolation
 	JobManager::SJobState m_WindJobState;
 	bool                  m_bWindJobRun;
@@ -974,6 +1197,8 @@ public:
 	// LiveCreate
 	virtual void SaveInternalState(struct IDataWriteStream& writer, const AABB& filterArea, const bool bTerrain, const uint32 objectMask);
 	virtual void LoadInternalState(struct IDataReadStream& reader, const uint8* pVisibleLayersMask, const uint16* pLayerIdTranslation);
+	// Drops the bases of delta snapshots, the next snapshot saved is a full one
+	void         ResetInternalStateBase();
 
 	void         SetupLightScissors(SRenderLight* pLight, const SRenderingPassInfo& passInfo) const;
 	bool         IsTerrainTextureStreamingInProgress() { return m_bTerrainTextureStreamingInProgress; }
@@ -1192,6 +1417,35 @@ private:
 	PodArray<float>     m_arrProcessStreamingLatencyTestResults;
 	PodArray<int>       m_arrProcessStreamingLatencyTexNum;
 
+	// Position of a scripted streaming latency run (e_SQTestRun) and its result
+	struct SStreamingLatencyRunPoint
+	{
+		Vec3   vPos;
+		Ang3   vAngDeg;
+		bool   bHasAngles;
+		float  fLatency;                  // Seconds until all requested data was resident, the timeout if bTimedOut
+		bool   bTimedOut;
+		int    nPendingTextures;          // Still pending when the point finished, only non zero on timeout
+		int    nPendingMeshes;
+		int    nPendingMergedMeshSectors;
+		size_t nMaxTexUsage;              // Peak size of the required streamed textures
+	};
+	struct SStreamingLatencyRun
+	{
+		std::vector<SStreamingLatencyRunPoint> points;
+		string reportPath;
+		size_t nCurrent;
+		float  fPointStartTime;
+		float  fSettledTime;              // Time all requested data was first resident, -1 if it is not
+		int    nFrames;                   // Frames spent at the current point
+		int    nSettledFrames;            // Consecutive frames all requested data was resident
+		int    nPendingTextures;          // Last texture count, refreshed every few frames
+		bool   bActive;
+
+		SStreamingLatencyRun() : nCurrent(0), fPointStartTime(0), fSettledTime(-1), nFrames(0), nSettledFrames(0), nPendingTextures(0), bActive(false) {}
+	};
+	SStreamingLatencyRun m_streamingLatencyRun;
+
 	// fields which are used by SRenderingPass to store over frame information
 	CryMT::CThreadSafePushContainer<CCamera> m_RenderingPassCameras[2];  // camera storage for SRenderingPass, the cameras cannot be stored on stack to allow job execution
 
@@ -1205,6 +1459,67 @@ private:
 
 	PodArray<IRenderNode*> m_deferredRenderProxyStreamingPriorityUpdates;     // deferred streaming priority updates for newly seen CRenderProxies
 
+	// Octree registration work of one frame
+	struct SOctreeUpdateStats
+	{
+		int   nRegisters;                        // RegisterEntity calls
+		int   nFastPath;                         // Updates keeping the object in its octree node and vis area
+		int   nInserts;                          // Objects (re)inserted into the octree
+		int   nUnregisters;                      // Objects removed from the octree
+		int   nDeferred;                         // Updates queued as the time budget was exhausted
+		int   nDequeued;                         // Queued updates processed
+		int   nQueueLength;                      // Queued updates left over at the end of the frame
+		int64 nTicks;                            // Time spent in AsyncOctreeUpdate
+		int   arrTypeUpdates[eERType_TypesNum];  // Updates per render node type
+
+		SOctreeUpdateStats() { Reset(); }
+		void Reset() { memset(this, 0, sizeof(*this)); }
+	};
+	// Precache point known to the precache scheduler
+	struct SScheduledPrecachePoint
+	{
+		int                  nId;
+		Vec3                 vDirection;
+		float                fTimeOut;
+		float                fImportanceFactor;
+		int                  nStartRoundId;  // Fast streaming priority round at activation
+		int                  nRoundPending;  // Pending stream work once the priority round covered the point, -1 before
+		int                  nLastPending;   // Pending stream work at the previous update
+		int                  nDrained;       // Stream work finished since nRoundPending was taken
+		int64                nStartBytes;    // Streamed memory at activation
+		SPrecachePointStatus status;
+	};
+	std::vector<SScheduledPrecachePoint> m_scheduledPrecachePoints;
+
+	// Last internal state saved or loaded, snapshots can be stored as a delta against it
+	struct SInternalStateBase
+	{
+		std::vector<uint8> data;
+		AABB               areaBox;
+		uint32             nObjectMask;
+		uint32             nTerrainSize;
+		uint8              nTerrainMask;
+		uint32             nCrc;
+		class COctreeNode* pObjectsTree; // Level the state belongs to
+
+		SInternalStateBase() : areaBox(AABB::RESET), nObjectMask(0), nTerrainSize(0), nTerrainMask(0), nCrc(0), pObjectsTree(nullptr) {}
+		bool Matches(uint8 terrainMask, uint32 objectMask, const AABB& box, uint32 terrainSize, size_t size) const
+		{
+			return !data.empty() && nTerrainMask == terrainMask && nObjectMask == objectMask && nTerrainSize == terrainSize && data.size() == size && IsEquivalent(areaBox, box, 0.0f);
+		}
+	};
+	SInternalStateBase m_internalStateSaveBase;
+	SInternalStateBase m_internalStateLoadBase;
+
+	void UpdatePrecacheScheduler();
+	void ActivatePrecachePoint(SScheduledPrecachePoint& point);
+
+	SOctreeUpdateStats               m_octreeUpdateStats;
+	SOctreeUpdateStats               m_octreeUpdateStatsLast;
+	std::vector<IRenderNode*>        m_octreeUpdateQueue;      // Updates deferred to later frames, in request order
+	size_t                           m_nOctreeUpdateQueueHead; // First unprocessed entry of m_octreeUpdateQueue
+	std::unordered_set<IRenderNode*> m_octreeUpdateQueued;     // Nodes with a pending entry in m_octreeUpdateQueue
+
 	float                  m_fLightsHDRDynamicPowerFactor; // lights hdr exponent/exposure
 
 	int                    m_nBlackTexID;
@@ -1297,7 +1612,19 @@ private:
 	int                                           m_nCurrentWindAreaList;
 	std::vector<SOptimizedOutdoorWindArea>        m_outdoorWindAreas[2];
 	std::vector<SOptimizedOutdoorWindArea>        m_indoorWindAreas[2];
-	std::vector<SOptimizedOutdoorWindArea>        m_forcedWindAreas;
+	SWindAreaGrid                                 m_outdoorWindAreaGrid[2];
+	SWindAreaGrid                                 m_indoorWindAreaGrid[2];
+	CForcedWindAreaRegistry                       m_forcedWindAreas;
+
+	// Box query index per render node type, built on the main thread by the first query of the type
+	CObjectTypeIndex                              m_objectTypeIndex[eERType_TypesNum];
+	CryCriticalSection                            m_objectTypeIndexLock;
+	volatile int                                  m_nObjectTypeIndexBuilt = 0; // Number of built indices
+	bool QueryObjectTypeIndex(EERType objType, const AABB& box, PodArray<IRenderNode*>& lstObjects, uint64 dwFlags);
+	void UpdateObjectTypeIndex(IRenderNode* pEnt, EERType eType, const AABB& box);
+	void RemoveFromObjectTypeIndex(IRenderNode* pEnt, EERType eType);
+	// Drops all per type indices, LoadLevel and UnloadLevel have to call it
+	void InvalidateObjectTypeIndex();
 
 	CLightVolumesMgr                              m_LightVolumesMgr;
 
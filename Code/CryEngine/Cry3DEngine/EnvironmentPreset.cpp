@@ -21,19 +21,25 @@ const float sBezierSplineKeyValueEpsilon = 0.001f;
 }
 
 CBezierSpline::CBezierSpline()
+	: m_nEditDepth(0)
+	, m_bSegmentsDirty(true)
 {
 	m_keys.reserve(2);
 }
 
 void CBezierSpline::Init(float fDefaultValue)
 {
+	BeginEdit();
 	m_keys.clear();
 	InsertKey(SAnimTime(0.0f), fDefaultValue);
 	InsertKey(SAnimTime(sAnimTimeSecondsIn24h), fDefaultValue);
+	EndEdit();
 }
 
 float CBezierSpline::Evaluate(float t) const
 {
+	CRY_ASSERT(m_nEditDepth == 0, "CBezierSpline::Evaluate called while keys are being edited");
+
 	if (m_keys.size() == 0)
 		return 0.0f;
 
@@ -72,16 +78,93 @@ float CBezierSpline::Evaluate(float t) const
 	}
 
 	const float timeInSegment = (time - startIt->m_time).ToFloat();
+	const size_t nSegment = startIt - m_keys.begin();
+
+	// Tangents only depend on the keys, so they are cached per segment whenever keys change.
+	// Keys written through GetKey()/SetKeys() outside an edit can leave the cache short, fall back then.
+	SSegment tempSegment;
+	const SSegment* pSegment = &tempSegment;
+	if (!m_bSegmentsDirty && m_segments.size() + 1 == m_keys.size())
+	{
+		pSegment = &m_segments[nSegment];
+	}
+	else
+	{
+		BuildSegment(nSegment, tempSegment);
+	}
+
+	const float factor = Bezier::InterpolationFactorFromX(timeInSegment, pSegment->duration, pSegment->start, pSegment->end);
+	const float fResult = Bezier::EvaluateY(factor, pSegment->start, pSegment->end);
+
+	return fResult;
+}
+
+void CBezierSpline::BuildSegment(size_t nSegment, SSegment& segment) const
+{
+	const TKeyContainer::const_iterator startIt = m_keys.begin() + nSegment;
 
 	const SBezierKey* pKeyLeftOfSegment = (startIt != m_keys.begin()) ? &*(startIt - 1) : NULL;
 	const SBezierKey* pKeyRightOfSegment = (startIt != (m_keys.end() - 2)) ? &*(startIt + 2) : NULL;
-	const SBezierKey segmentStart = Bezier::ApplyOutTangent(*startIt, pKeyLeftOfSegment, *(startIt + 1));
-	const SBezierKey segmentEnd = Bezier::ApplyInTangent(*(startIt + 1), *startIt, pKeyRightOfSegment);
 
-	const float factor = Bezier::InterpolationFactorFromX(timeInSegment, deltaTime.ToFloat(), segmentStart.m_controlPoint, segmentEnd.m_controlPoint);
-	const float fResult = Bezier::EvaluateY(factor, segmentStart.m_controlPoint, segmentEnd.m_controlPoint);
+	segment.start = Bezier::ApplyOutTangent(*startIt, pKeyLeftOfSegment, *(startIt + 1)).m_controlPoint;
+	segment.end = Bezier::ApplyInTangent(*(startIt + 1), *startIt, pKeyRightOfSegment).m_controlPoint;
+	segment.duration = ((startIt + 1)->m_time - startIt->m_time).ToFloat();
+}
 
-	return fResult;
+void CBezierSpline::RebuildSegments()
+{
+	const size_t nSegmentCount = (m_keys.size() > 1) ? m_keys.size() - 1 : 0;
+	m_segments.resize(nSegmentCount);
+	for (size_t i = 0; i < nSegmentCount; ++i)
+	{
+		BuildSegment(i, m_segments[i]);
+	}
+
+	m_bSegmentsDirty = false;
+}
+
+void CBezierSpline::RebuildSegmentsAround(size_t nKey, bool bInserted)
+{
+	const size_t nSegmentCount = (m_keys.size() > 1) ? m_keys.size() - 1 : 0;
+	const size_t nPrevSegmentCount = bInserted ? nSegmentCount - 1 : nSegmentCount;
+	if (m_bSegmentsDirty || nSegmentCount < 2 || m_segments.size() != nPrevSegmentCount)
+	{
+		RebuildSegments();
+		return;
+	}
+
+	if (bInserted)
+	{
+		m_segments.insert(m_segments.begin() + min(nKey, m_segments.size()), SSegment());
+	}
+
+	// Tangents of a segment depend on the key before and after it, so a key affects at most the
+	// two segments on either side of it
+	const size_t nFirst = (nKey > 2) ? nKey - 2 : 0;
+	const size_t nLast = min(nKey + 1, nSegmentCount - 1);
+	for (size_t i = nFirst; i <= nLast; ++i)
+	{
+		BuildSegment(i, m_segments[i]);
+	}
+}
+
+void CBezierSpline::BeginEdit()
+{
+	++m_nEditDepth;
+}
+
+void CBezierSpline::EndEdit()
+{
+	CRY_ASSERT(m_nEditDepth > 0);
+	if (--m_nEditDepth == 0)
+	{
+		// Keys inserted during the edit are appended unsorted, keep insertion order for equal times
+		std::stable_sort(m_keys.begin(), m_keys.end(), [](const SBezierKey& a, const SBezierKey& b)
+		{
+			return a.m_time < b.m_time;
+		});
+		RebuildSegments();
+	}
 }
 
 void CBezierSpline::InsertKey(SAnimTime time, float value)
@@ -90,29 +173,50 @@ void CBezierSpline::InsertKey(SAnimTime time, float value)
 	key.m_time = time;
 	key.m_controlPoint.m_value = value;
 
-	const size_t nKeyNum = m_keys.size();
-	for (size_t i = 0; i < nKeyNum; ++i)
+	if (m_nEditDepth > 0)
 	{
-		if (m_keys[i].m_time > time)
-		{
-			m_keys.insert(m_keys.begin() + i, key);
-			return;
-		}
+		m_keys.push_back(key);
+		m_bSegmentsDirty = true;
+		return;
 	}
 
-	m_keys.push_back(key);
+	const TKeyContainer::iterator it = std::upper_bound(m_keys.begin(), m_keys.end(), time, SCompKeyTime());
+	const size_t nKey = it - m_keys.begin();
+	m_keys.insert(it, key);
+	RebuildSegmentsAround(nKey, true);
 }
 
 void CBezierSpline::UpdateKeyForTime(float fTime, float value)
 {
 	const SAnimTime time(fTime);
 
-	const size_t nKeyNum = m_keys.size();
-	for (size_t i = 0; i < nKeyNum; ++i)
+	if (m_nEditDepth > 0)
+	{
+		// keys are not sorted while editing
+		const size_t nKeyNum = m_keys.size();
+		for (size_t i = 0; i < nKeyNum; ++i)
+		{
+			if (fabs(m_keys[i].m_time.ToFloat() - fTime) < sBezierSplineKeyValueEpsilon)
+			{
+				m_keys[i].m_controlPoint.m_value = value;
+				m_bSegmentsDirty = true;
+				return;
+			}
+		}
+	}
+	else
 	{
-		if (fabs(m_keys[i].m_time.ToFloat() - fTime) < sBezierSplineKeyValueEpsilon)
+		// first key that can be within epsilon of the requested time
+		TKeyContainer::iterator it = std::upper_bound(m_keys.begin(), m_keys.end(), SAnimTime(fTime - sBezierSplineKeyValueEpsilon), SCompKeyTime());
+		if (it != m_keys.begin() && fabs((it - 1)->m_time.ToFloat() - fTime) < sBezierSplineKeyValueEpsilon)
 		{
-			m_keys[i].m_controlPoint.m_value = value;
+			--it;
+		}
+
+		if (it != m_keys.end() && fabs(it->m_time.ToFloat() - fTime) < sBezierSplineKeyValueEpsilon)
+		{
+			it->m_controlPoint.m_value = value;
+			RebuildSegmentsAround(it - m_keys.begin(), false);
 			return;
 		}
 	}
@@ -123,6 +227,11 @@ void CBezierSpline::UpdateKeyForTime(float fTime, float value)
 void CBezierSpline::Serialize(Serialization::IArchive& ar)
 {
 	ar(m_keys, "keys");
+
+	if (ar.isInput())
+	{
+		RebuildSegments();
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -202,7 +311,9 @@ bool CTimeOfDayVariable::SetSplineKeys(int nSpline, const SBezierKey* keysArray,
 {
 	if (CBezierSpline* pSpline = GetSpline(nSpline))
 	{
+		pSpline->BeginEdit();
 		pSpline->SetKeys(keysArray, keysArraySize);
+		pSpline->EndEdit();
 		return true;
 	}
 	return false;
@@ -218,6 +329,21 @@ bool CTimeOfDayVariable::UpdateSplineKeyForTime(int nSpline, float fTime, float
 	return false;
 }
 
+bool CTimeOfDayVariable::UpdateSplineKeysForTimes(int nSpline, const float* pTimes, const float* pNewKeys, unsigned int nCount)
+{
+	if (CBezierSpline* pSpline = GetSpline(nSpline))
+	{
+		pSpline->BeginEdit();
+		for (unsigned int i = 0; i < nCount; ++i)
+		{
+			pSpline->UpdateKeyForTime(pTimes[i], pNewKeys[i]);
+		}
+		pSpline->EndEdit();
+		return true;
+	}
+	return false;
+}
+
 void CTimeOfDayVariable::Serialize(Serialization::IArchive& ar)
 {
 	ar(m_id, "id");
@@ -520,6 +646,15 @@ bool CTimeOfDayVariables::UpdateSplineKeyForVar(int nIndex, int nSpline, float f
 	return false;
 }
 
+bool CTimeOfDayVariables::UpdateSplineKeysForVar(int nIndex, int nSpline, const float* pTimes, const float* pNewValues, unsigned int nCount)
+{
+	if (nIndex >= 0 && nIndex < ITimeOfDay::PARAM_TOTAL)
+	{
+		return m_vars[nIndex].UpdateSplineKeysForTimes(nSpline, pTimes, pNewValues, nCount);
+	}
+	return false;
+}
+
 CTimeOfDayVariable* CTimeOfDayVariables::GetVar(const char* varName)
 {
 	for (size_t i = 0; i < ITimeOfDay::PARAM_TOTAL; ++i)
@@ -613,7 +748,9 @@ void CEnvironmentPreset::ReadVariablesFromXML(Serialization::IArchive& ar, CTime
 					SBezierKey& key = tempKeys[k];
 					key.m_time *= sAnimTimeSecondsIn24h;
 				}
+				pSpline->BeginEdit();
 				pSpline->SetKeys(&tempKeys[0], nKeyCount);
+				pSpline->EndEdit();
 			}
 		}
 
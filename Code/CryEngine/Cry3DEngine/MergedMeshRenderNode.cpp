@@ -4,6 +4,7 @@
 
 #include <numeric>
 #include <algorithm>
+#include <deque>
 #include <unordered_map>
 
 #include <CryMath/Cry_Geo.h>
@@ -15,6 +16,8 @@
 #include <Cry3DEngine/IIndexedMesh.h>
 #include <CryMath/QTangent.h>
 #include <CryString/StringUtils.h>
+#include <CryCore/BitFiddling.h>
+#include <CryCore/CryCrc32.h>
 
 #include "MergedMeshRenderNode.h"
 #include "MergedMeshGeometry.h"
@@ -28,6 +31,7 @@ namespace
 {
 static _smart_ptr<IGeneralMemoryHeap> s_MergedMeshPool;
 static CryCriticalSection s_MergedMeshPoolLock;
+static CryCriticalSection s_StreamingCameraLock;
 
 static inline SMeshBoneMapping_uint8 _SortBoneMapping(const SMeshBoneMapping_uint8& a)
 {
@@ -783,6 +787,149 @@ STRUCT_VAR_INFO(m_StatInstGroupID, TYPE_INFO(uint32))
 STRUCT_VAR_INFO(m_nSamples, TYPE_INFO(uint32))
 STRUCT_INFO_END(SMergedMeshSectorChunk)
 
+////////////////////////////////////////////////////////////////////////////////
+// Packed sector format
+//
+// Instead of an array of SMergedMeshInstanceCompressed records, each sector
+// chunk of a packed sector is followed by the byte size of its instance
+// stream and the instances in blocks of MMRM_PACKED_BLOCK_SIZE. A block stores
+// per position component the block minimum and the bit width of the offsets
+// to it, the bit packed offsets, and then the scales and rotations as
+// separate byte streams. All multi byte values are stored little endian.
+#define MMRM_PACKED_BLOCK_SIZE (64u)
+
+static const uint32 c_MergedMeshPackedChunkVersion = c_MergedMeshChunkVersion | BIT(16);
+
+// 0 = export legacy sectors, 1 = export packed sectors
+static int e_MergedMeshesPackedSectors = 1;
+
+static inline void PackedPut32(std::vector<uint8>& out, uint32 value)
+{
+	for (int i = 0; i < 4; ++i)
+		out.push_back((uint8)(value >> (i * 8)));
+}
+
+static inline uint32 PackedGet32(const uint8* data)
+{
+	return (uint32)data[0] | ((uint32)data[1] << 8) | ((uint32)data[2] << 16) | ((uint32)data[3] << 24);
+}
+
+static void PackSectorInstances(const SMergedMeshInstanceCompressed* instances, size_t count, std::vector<uint8>& out)
+{
+	for (size_t base = 0; base < count; base += MMRM_PACKED_BLOCK_SIZE)
+	{
+		const size_t n = min(count - base, (size_t)MMRM_PACKED_BLOCK_SIZE);
+		const SMergedMeshInstanceCompressed* block = instances + base;
+		for (int c = 0; c < 3; ++c)
+		{
+			uint32 lo = ~0u, hi = 0u, bits = 0u;
+			for (size_t i = 0; i < n; ++i)
+			{
+				const uint32 v = (&block[i].pos_x)[c];
+				lo = min(lo, v);
+				hi = max(hi, v);
+			}
+			while (bits < 32 && ((hi - lo) >> bits))
+				++bits;
+			PackedPut32(out, lo);
+			out.push_back((uint8)bits);
+
+			uint64 acc = 0;
+			uint32 nacc = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				acc |= (uint64)((&block[i].pos_x)[c] - lo) << nacc;
+				for (nacc += bits; nacc >= 8; nacc -= 8, acc >>= 8)
+					out.push_back((uint8)acc);
+			}
+			if (nacc)
+				out.push_back((uint8)acc);
+		}
+		for (size_t i = 0; i < n; ++i)
+			out.push_back(block[i].scale);
+		for (int r = 0; r < 4; ++r)
+			for (size_t i = 0; i < n; ++i)
+				out.push_back((uint8)block[i].rot[r]);
+	}
+}
+
+// Expands count packed instances from data into records, returns the number
+// of bytes consumed or 0 if the stream is truncated
+static size_t UnpackSectorInstances(const uint8* data, size_t size, SMergedMeshInstanceCompressed* instances, size_t count)
+{
+	const uint8* ptr = data;
+	const uint8* end = data + size;
+	for (size_t base = 0; base < count; base += MMRM_PACKED_BLOCK_SIZE)
+	{
+		const size_t n = min(count - base, (size_t)MMRM_PACKED_BLOCK_SIZE);
+		SMergedMeshInstanceCompressed* block = instances + base;
+		for (int c = 0; c < 3; ++c)
+		{
+			if (end - ptr < 5)
+				return 0;
+			const uint32 lo = PackedGet32(ptr);
+			const uint32 bits = ptr[4];
+			const size_t nbytes = (n * bits + 7) >> 3;
+			ptr += 5;
+			if (bits > 32 || (size_t)(end - ptr) < nbytes)
+				return 0;
+
+			const uint64 mask = (1ull << bits) - 1ull;
+			uint64 acc = 0;
+			uint32 nacc = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				for (; nacc < bits; nacc += 8)
+					acc |= (uint64)(*ptr++) << nacc;
+				(&block[i].pos_x)[c] = lo + (uint32)(acc & mask);
+				acc >>= bits;
+				nacc -= bits;
+			}
+		}
+		if ((size_t)(end - ptr) < n * 5)
+			return 0;
+		for (size_t i = 0; i < n; ++i)
+			block[i].scale = *ptr++;
+		for (int r = 0; r < 4; ++r)
+			for (size_t i = 0; i < n; ++i)
+				block[i].rot[r] = (int8)*ptr++;
+	}
+	return (size_t)(ptr - data);
+}
+
+// Expands a packed sector into the legacy chunk layout consumed by
+// CMergedMeshRenderNode::InitializeSamples
+static bool UnpackSector(const uint8* pBuffer, size_t nSize, std::vector<uint8>& out)
+{
+	const uint8* end = pBuffer + nSize;
+	PodArray<SMergedMeshInstanceCompressed> instances;
+	out.clear();
+	while (pBuffer < end)
+	{
+		if ((size_t)(end - pBuffer) < sizeof(SMergedMeshSectorChunk) + 4)
+			return false;
+		SMergedMeshSectorChunk sectorChunk = *StepData<SMergedMeshSectorChunk>(pBuffer, eLittleEndian);
+		const uint32 streamSize = PackedGet32(pBuffer);
+		pBuffer += 4;
+		if (sectorChunk.ver != c_MergedMeshPackedChunkVersion || (size_t)(end - pBuffer) < streamSize)
+			return false;
+
+		instances.resize(sectorChunk.m_nSamples);
+		if (UnpackSectorInstances(pBuffer, streamSize, instances.GetElements(), sectorChunk.m_nSamples) != streamSize)
+			return false;
+		pBuffer += streamSize;
+
+		size_t offset = out.size();
+		out.resize(offset + sizeof(SMergedMeshSectorChunk) + sectorChunk.m_nSamples * sizeof(SMergedMeshInstanceCompressed));
+		byte* pPtr = &out[offset];
+		sectorChunk.ver = c_MergedMeshChunkVersion;
+		AddToPtr(pPtr, sectorChunk, eLittleEndian);
+		for (uint32 i = 0; i < sectorChunk.m_nSamples; ++i)
+			AddToPtr(pPtr, instances[i], eLittleEndian);
+	}
+	return true;
+}
+
 DECLARE_JOB(
   "PVRNCullSamples"
   , TPVRNCullRenderMesh
@@ -825,6 +972,16 @@ struct SMergedMeshGlobals
 };
 static CRY_ALIGN(128) SMergedMeshGlobals s_mmrm_globals;
 
+// Seconds the camera position is extrapolated to find sectors to prefetch (0 = disabled)
+static float e_MergedMeshesStreamingLookahead = 2.f;
+// Camera speed in m/s at which the streaming budget reaches its maximum
+static float e_MergedMeshesStreamingFastSpeed = 40.f;
+// Stream requests per frame for a static and a fast moving camera
+static int e_MergedMeshesStreamRequestsMin = 16;
+static int e_MergedMeshesStreamRequestsMax = 64;
+// 0 = compile sectors and areas on the calling thread, 1 = compile them in jobs
+static int e_MergedMeshesParallelCompile = 1;
+
 template<typename T>
 static inline void resize_list(T*& list, size_t nsize, size_t align)
 {
@@ -1128,6 +1285,278 @@ inline void QueryProjectiles(SMMRMProjectile*& pColliders, int& nColliders, cons
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Per frame broadphase of the colliders and projectiles around the nodes that
+// are post rendered this frame
+//
+// The physical world is queried once for the bounds of all these nodes instead
+// of once per node, and every entity is converted to spheres only once. The
+// spheres and projectile segments are binned into a uniform grid over those
+// bounds, so a node only tests the primitives of the cells it overlaps. If a
+// node finds more candidates than MMRM_MAX_COLLIDERS / MMRM_MAX_PROJECTILES,
+// it keeps the largest colliders and the youngest projectiles instead of the
+// first ones the physics happened to return.
+
+// 0 = query colliders and projectiles per node, 1 = use the shared broadphase
+static int e_MergedMeshesBroadphase = 1;
+
+class CMergedMeshBroadphase
+{
+	enum { MaxCellsPerAxis = 32, MaxEntities = 256 };
+
+	struct SSegment
+	{
+		Lineseg seg;
+		Vec3    dir;
+		float   r;
+		float   lifetime;
+	};
+
+	struct SGrid
+	{
+		std::vector<uint32> cells;   // offsets of the cells into indices
+		std::vector<uint32> indices; // primitives binned per cell
+	};
+
+	AABB                            m_bounds;
+	Vec3                            m_cellSizeRec;
+	int                             m_dim[3];
+	std::vector<primitives::sphere> m_spheres;
+	std::vector<SSegment>           m_segments;
+	SGrid                           m_sphereGrid;
+	SGrid                           m_segmentGrid;
+	std::vector<uint32>             m_sphereStamps;
+	std::vector<uint32>             m_segmentStamps;
+	std::vector<uint32>             m_candidates;
+	uint32                          m_stamp;
+	bool                            m_valid;
+
+	void CellRange(const AABB& box, int (&lo)[3], int (&hi)[3]) const
+	{
+		for (int a = 0; a < 3; ++a)
+		{
+			lo[a] = clamp_tpl((int)((box.min[a] - m_bounds.min[a]) * m_cellSizeRec[a]), 0, m_dim[a] - 1);
+			hi[a] = clamp_tpl((int)((box.max[a] - m_bounds.min[a]) * m_cellSizeRec[a]), 0, m_dim[a] - 1);
+		}
+	}
+
+	// Counting sort of the primitive boxes into the cells of the grid
+	void Bin(const std::vector<AABB>& boxes, SGrid& grid) const
+	{
+		const size_t ncells = (size_t)m_dim[0] * m_dim[1] * m_dim[2];
+		grid.cells.assign(ncells + 1, 0u);
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			for (size_t p = 0; p < boxes.size(); ++p)
+			{
+				int lo[3], hi[3];
+				CellRange(boxes[p], lo, hi);
+				for (int z = lo[2]; z <= hi[2]; ++z)
+					for (int y = lo[1]; y <= hi[1]; ++y)
+						for (int x = lo[0]; x <= hi[0]; ++x)
+						{
+							const size_t cell = x + (y + (size_t)z * m_dim[1]) * m_dim[0];
+							if (pass == 0)
+								++grid.cells[cell + 1];
+							else
+								grid.indices[grid.cells[cell]++] = (uint32)p;
+						}
+			}
+			if (pass == 0)
+			{
+				for (size_t c = 0; c < ncells; ++c)
+					grid.cells[c + 1] += grid.cells[c];
+				grid.indices.resize(grid.cells[ncells]);
+			}
+		}
+		// The fill pass advanced every offset to the start of the next cell
+		for (size_t c = ncells; c > 0; --c)
+			grid.cells[c] = grid.cells[c - 1];
+		grid.cells[0] = 0;
+	}
+
+	// Collects the primitives of the cells overlapping the box, each only once
+	void Gather(const AABB& box, const SGrid& grid, std::vector<uint32>& stamps)
+	{
+		int lo[3], hi[3];
+		CellRange(box, lo, hi);
+		m_candidates.clear();
+		if (++m_stamp == 0)
+		{
+			std::fill(m_sphereStamps.begin(), m_sphereStamps.end(), 0u);
+			std::fill(m_segmentStamps.begin(), m_segmentStamps.end(), 0u);
+			m_stamp = 1;
+		}
+		for (int z = lo[2]; z <= hi[2]; ++z)
+			for (int y = lo[1]; y <= hi[1]; ++y)
+				for (int x = lo[0]; x <= hi[0]; ++x)
+				{
+					const size_t cell = x + (y + (size_t)z * m_dim[1]) * m_dim[0];
+					for (uint32 i = grid.cells[cell]; i < grid.cells[cell + 1]; ++i)
+					{
+						const uint32 p = grid.indices[i];
+						if (stamps[p] == m_stamp)
+							continue;
+						stamps[p] = m_stamp;
+						m_candidates.push_back(p);
+					}
+				}
+	}
+
+public:
+	CMergedMeshBroadphase() : m_stamp(0), m_valid(false) {}
+
+	// Queries the physical world for the colliders inside the bounds
+	void Begin(const AABB& bounds)
+	{
+		m_valid = false;
+		m_spheres.clear();
+		m_segments.clear();
+		if (!e_MergedMeshesBroadphase || bounds.IsReset())
+			return;
+
+		m_bounds = bounds;
+		const Vec3 size = bounds.GetSize();
+		for (int a = 0; a < 3; ++a)
+		{
+			const float cellSize = max(size[a] / (float)MaxCellsPerAxis, c_MergedMeshesExtent * 0.25f);
+			m_dim[a] = clamp_tpl((int)ceilf(size[a] / cellSize), 1, (int)MaxCellsPerAxis);
+			m_cellSizeRec[a] = (float)m_dim[a] / max(size[a], FLT_EPSILON);
+		}
+
+		IPhysicalEntity* pents[MaxEntities];
+		IPhysicalEntity** pentList = &pents[0];
+		const int nents = gEnv->pPhysicalWorld->GetEntitiesInBox(
+		  bounds.min, bounds.max,
+		  pentList,
+		  ent_sleeping_rigid | ent_rigid | ent_living | ent_allocate_list,
+		  MaxEntities);
+		primitives::sphere spheres[MMRM_MAX_COLLIDERS];
+		for (int j = 0; j < nents; ++j)
+		{
+			if (!pentList[j])
+				continue;
+			int nspheres = 0;
+			ExtractSphereSet(pentList[j], spheres, nspheres, bounds);
+			m_spheres.insert(m_spheres.end(), spheres, spheres + nspheres);
+		}
+		if (pents != pentList)
+			gEnv->pPhysicalWorld->GetPhysUtils()->DeletePointer(pentList);
+		m_valid = true;
+	}
+
+	// Copies the projectile segments inside the bounds, must be called with the
+	// projectile lock held
+	void AddProjectiles(const std::vector<SProjectile>& projectiles)
+	{
+		if (!m_valid)
+			return;
+		for (size_t i = 0, end = projectiles.size(); i < end; ++i)
+		{
+			const SProjectile& projectile = projectiles[i];
+			const Lineseg seg(projectile.initial_pos, projectile.current_pos);
+			if (Overlap::Lineseg_AABB(seg, m_bounds) == false)
+				continue;
+			SSegment segment = { seg, projectile.direction, projectile.size, projectile.lifetime };
+			m_segments.push_back(segment);
+		}
+	}
+
+	// Bins the gathered primitives
+	void Finish()
+	{
+		if (!m_valid)
+			return;
+		std::vector<AABB> boxes;
+		boxes.reserve(max(m_spheres.size(), m_segments.size()));
+		for (size_t i = 0; i < m_spheres.size(); ++i)
+		{
+			const Vec3 r(m_spheres[i].r, m_spheres[i].r, m_spheres[i].r);
+			boxes.push_back(AABB(m_spheres[i].center - r, m_spheres[i].center + r));
+		}
+		Bin(boxes, m_sphereGrid);
+		boxes.clear();
+		for (size_t i = 0; i < m_segments.size(); ++i)
+		{
+			AABB box(AABB::RESET);
+			box.Add(m_segments[i].seg.start);
+			box.Add(m_segments[i].seg.end);
+			boxes.push_back(box);
+		}
+		Bin(boxes, m_segmentGrid);
+		m_sphereStamps.assign(m_spheres.size(), 0u);
+		m_segmentStamps.assign(m_segments.size(), 0u);
+		m_stamp = 0;
+	}
+
+	void End() { m_valid = false; }
+
+	// Returns false if the box is not covered by the broadphase of this frame
+	bool QueryColliders(primitives::sphere*& pColliders, int& nColliders, const AABB& box)
+	{
+		if (!m_valid || !m_bounds.ContainsBox(box))
+			return false;
+		if (!pColliders) resize_list(pColliders, MMRM_MAX_COLLIDERS, 16);
+		Gather(box, m_sphereGrid, m_sphereStamps);
+		nColliders = 0;
+		for (size_t i = 0; i < m_candidates.size(); ++i)
+		{
+			const primitives::sphere& sphere = m_spheres[m_candidates[i]];
+			if (Overlap::Sphere_AABB(Sphere(sphere.center, sphere.r), box))
+				m_candidates[nColliders++] = m_candidates[i];
+		}
+		m_candidates.resize(nColliders);
+		if (nColliders > MMRM_MAX_COLLIDERS)
+		{
+			const std::vector<primitives::sphere>& spheres = m_spheres;
+			std::partial_sort(m_candidates.begin(), m_candidates.begin() + MMRM_MAX_COLLIDERS, m_candidates.end(),
+			                  [&spheres](uint32 a, uint32 b) { return spheres[a].r > spheres[b].r; });
+			nColliders = MMRM_MAX_COLLIDERS;
+		}
+		for (int i = 0; i < nColliders; ++i)
+			pColliders[i] = m_spheres[m_candidates[i]];
+		std::sort(pColliders, pColliders + nColliders, SortCollider);
+		return true;
+	}
+
+	// Returns false if the box is not covered by the broadphase of this frame
+	bool QueryProjectiles(SMMRMProjectile*& pColliders, int& nColliders, const AABB& box)
+	{
+		if (!m_valid || !m_bounds.ContainsBox(box))
+			return false;
+		if (!pColliders) resize_list(pColliders, MMRM_MAX_PROJECTILES, 16);
+		Gather(box, m_segmentGrid, m_segmentStamps);
+		nColliders = 0;
+		for (size_t i = 0; i < m_candidates.size(); ++i)
+		{
+			if (Overlap::Lineseg_AABB(m_segments[m_candidates[i]].seg, box))
+				m_candidates[nColliders++] = m_candidates[i];
+		}
+		m_candidates.resize(nColliders);
+		if (nColliders > MMRM_MAX_PROJECTILES)
+		{
+			const std::vector<SSegment>& segments = m_segments;
+			std::partial_sort(m_candidates.begin(), m_candidates.begin() + MMRM_MAX_PROJECTILES, m_candidates.end(),
+			                  [&segments](uint32 a, uint32 b) { return segments[a].lifetime > segments[b].lifetime; });
+			nColliders = MMRM_MAX_PROJECTILES;
+		}
+		for (int i = 0; i < nColliders; ++i)
+		{
+			const SSegment& segment = m_segments[m_candidates[i]];
+			pColliders[i].pos[0] = segment.seg.start;
+			pColliders[i].pos[1] = segment.seg.end;
+			pColliders[i].dir = segment.dir;
+			pColliders[i].r = segment.r;
+		}
+		return true;
+	}
+};
+
+static CMergedMeshBroadphase s_Broadphase;
+
+// 0 = sample the wind areas analytically, 1 = interpolate the engine's wind grid
+static int e_MergedMeshesWindGrid = 0;
+
 static inline void SampleWind(Vec3*& wind, const AABB& bbox)
 {
 	if (!wind) resize_list(wind, cube(MMRM_WIND_DIM), 16);
@@ -1143,7 +1572,10 @@ static inline void SampleWind(Vec3*& wind, const AABB& bbox)
 	Vec3* copy = new Vec3[cube(MMRM_WIND_DIM)];
 	memcpy(copy, wind, sizeof(Vec3) * cube(MMRM_WIND_DIM));
 #endif
-	if (!Cry3DEngineBase::Get3DEngine()->SampleWind(wind, (MMRM_WIND_DIM)*(MMRM_WIND_DIM)*(MMRM_WIND_DIM), bbox, false))
+	const bool bSampled = e_MergedMeshesWindGrid
+	                      ? Cry3DEngineBase::Get3DEngine()->SampleWindGrid(wind, (MMRM_WIND_DIM)*(MMRM_WIND_DIM)*(MMRM_WIND_DIM), bbox, false)
+	                      : Cry3DEngineBase::Get3DEngine()->SampleWind(wind, (MMRM_WIND_DIM)*(MMRM_WIND_DIM)*(MMRM_WIND_DIM), bbox, false);
+	if (!bSampled)
 	{
 		for (size_t x = 0; x < MMRM_WIND_DIM; ++x)
 			for (size_t y = 0; y < MMRM_WIND_DIM; ++y)
@@ -1173,6 +1605,320 @@ struct RenderMeshMeta
 	uint32     indices;
 };
 
+// Size in KB of released rendermeshes the pool keeps around for reuse (0 disables pooling)
+static int e_MergedMeshesRenderMeshPoolSize = 16384;
+// Number of frames a node's dynamic rendermesh survives without the node being drawn
+static int e_MergedMeshesDynamicMeshRetainFrames = 8;
+
+////////////////////////////////////////////////////////////////////////////////
+// Pool of merged rendermeshes
+//
+// Rendermeshes are bucketed by their power of two vertex and index capacity,
+// so a mesh released by one node can be refilled by any node whose culling
+// result falls into the same bucket. A released mesh is only handed out again
+// after MMRM_RENDERMESH_POOL_LATENCY frames, as the renderer might still
+// reference its previous contents.
+class CMergedMeshRenderMeshPool
+{
+	struct SEntry
+	{
+		_smart_ptr<IRenderMesh> rm;
+		uint32                  releaseFrame;
+		uint32                  sizeInVram;
+	};
+	typedef std::deque<SEntry>                    EntryListT;
+	typedef std::unordered_map<uint32, EntryListT> BucketMapT;
+
+	BucketMapT         m_buckets;
+	size_t             m_freeSizeInVram;
+	CryCriticalSection m_lock;
+
+	static uint32 BucketKey(uint32 vertexCapacity, uint32 indexCapacity)
+	{
+		return (IntegerLog2_RoundUp(vertexCapacity) << 8) | IntegerLog2_RoundUp(indexCapacity);
+	}
+
+public:
+	CMergedMeshRenderMeshPool() : m_freeSizeInVram() {}
+
+	static uint32 VertexCapacity(uint32 vertices) { return 1u << IntegerLog2_RoundUp(max(vertices, 1u)); }
+	static uint32 IndexCapacity(uint32 indices)   { return 1u << IntegerLog2_RoundUp(max(indices, 1u)); }
+	static uint32 SizeInVram(uint32 vertices, uint32 indices)
+	{
+		return (sizeof(SVF_P3S_C4B_T2S) + sizeof(SPipTangents)) * vertices + sizeof(vtx_idx) * indices;
+	}
+
+	// Returns a rendermesh able to hold the given number of vertices and indices
+	_smart_ptr<IRenderMesh> Acquire(uint32 vertices, uint32 indices, uint32 frameId)
+	{
+		const uint32 vertexCapacity = VertexCapacity(vertices);
+		const uint32 indexCapacity = IndexCapacity(indices);
+		if (e_MergedMeshesRenderMeshPoolSize > 0)
+		{
+			AUTO_LOCK(m_lock);
+			BucketMapT::iterator found = m_buckets.find(BucketKey(vertexCapacity, indexCapacity));
+			if (found != m_buckets.end() && !found->second.empty())
+			{
+				// Entries are appended in release order, so the front is the oldest
+				SEntry& entry = found->second.front();
+				if (frameId - entry.releaseFrame >= MMRM_RENDERMESH_POOL_LATENCY)
+				{
+					_smart_ptr<IRenderMesh> rm = entry.rm;
+					m_freeSizeInVram -= entry.sizeInVram;
+					found->second.pop_front();
+					return rm;
+				}
+			}
+		}
+		return Cry3DEngineBase::GetRenderer()->CreateRenderMeshInitialized(
+		  NULL, vertexCapacity, EDefaultInputLayouts::P3S_C4B_T2S, NULL, indexCapacity,
+		  prtTriangleList, "MergedMesh", "MergedMesh", eRMT_Dynamic);
+	}
+
+	// Hands a rendermesh back to the pool
+	void Release(_smart_ptr<IRenderMesh>& rm, uint32 frameId)
+	{
+		if (!rm)
+			return;
+		if (e_MergedMeshesRenderMeshPoolSize > 0)
+		{
+			const uint32 vertexCapacity = rm->GetVerticesCount();
+			const uint32 indexCapacity = rm->GetIndicesCount();
+			SEntry entry;
+			entry.rm = rm;
+			entry.releaseFrame = frameId;
+			entry.sizeInVram = SizeInVram(vertexCapacity, indexCapacity);
+
+			AUTO_LOCK(m_lock);
+			m_buckets[BucketKey(vertexCapacity, indexCapacity)].push_back(entry);
+			m_freeSizeInVram += entry.sizeInVram;
+		}
+		rm = NULL;
+	}
+
+	// Frees the oldest released rendermeshes until the pool fits its size limit
+	void Trim()
+	{
+		const size_t maxSize = (size_t)max(e_MergedMeshesRenderMeshPoolSize, 0) << 10;
+		AUTO_LOCK(m_lock);
+		while (m_freeSizeInVram > maxSize)
+		{
+			EntryListT* pOldest = NULL;
+			for (BucketMapT::iterator it = m_buckets.begin(); it != m_buckets.end(); ++it)
+			{
+				if (!it->second.empty() && (!pOldest || (int)(it->second.front().releaseFrame - pOldest->front().releaseFrame) < 0))
+					pOldest = &it->second;
+			}
+			if (!pOldest)
+				break;
+			m_freeSizeInVram -= pOldest->front().sizeInVram;
+			pOldest->pop_front();
+		}
+	}
+
+	void Clear()
+	{
+		AUTO_LOCK(m_lock);
+		stl::free_container(m_buckets);
+		m_freeSizeInVram = 0;
+	}
+
+	size_t FreeSizeInVram() const { return m_freeSizeInVram; }
+};
+
+static CMergedMeshRenderMeshPool s_RenderMeshPool;
+
+////////////////////////////////////////////////////////////////////////////////
+// Preprocessed geometry cache
+//
+// The chunks, spines and deform data the geometry manager bakes from a cgf are
+// written to a per-cgf file below the user folder after the first preparation
+// and read back on later runs instead of walking the rendermeshes again. A
+// cache file is only accepted if its version, the layout of the cached
+// structures, the preprocessing options and the timestamp and size of the
+// source cgf match, and the crc32 over the payload is valid.
+
+// 0 = disabled, 1 = load and store cached geometry, 2 = load only
+static int e_MergedMeshesGeometryCache = 1;
+
+#define MMRM_GEOMETRY_CACHE_FOLDER "%USER%/MergedMeshCache"
+
+static const uint32 c_MergedMeshGeomCacheMagic = 0x43474d4d; // "MMGC"
+static const uint32 c_MergedMeshGeomCacheVersion = 2u;
+
+enum EMergedMeshGeomCacheFlags
+{
+	MMRM_GEOMCACHE_TESSELATION = BIT(0),
+	MMRM_GEOMCACHE_DEFORM      = BIT(1),
+	MMRM_GEOMCACHE_SPINES      = BIT(2),
+};
+
+struct SMergedMeshGeomCacheHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint32 layout;      // crc32 over the sizes of all cached structures
+	uint32 flags;       // preprocessing options the cached data depends on
+	uint64 srcTime;     // crc32 over modification time, size and name of every source file
+	uint64 srcSize;     // total size of the source files
+	uint32 payloadSize;
+	uint32 payloadCrc;
+};
+
+static uint32 GeomCacheLayout()
+{
+	const uint32 sizes[] =
+	{
+		sizeof(SMMRMGeometry),
+		sizeof(SMMRMChunk),
+		sizeof(((SMMRMChunk*)0)->general[0]),
+		sizeof(((SMMRMChunk*)0)->qtangents[0]),
+		sizeof(((SMMRMChunk*)0)->normals[0]),
+		sizeof(((SMMRMChunk*)0)->weights[0]),
+		sizeof(((SMMRMChunk*)0)->skin_vertices[0]),
+		sizeof(((SMMRMGeometry*)0)->pSpineInfo[0]),
+		sizeof(((SMMRMGeometry*)0)->pSpineVtx[0]),
+		sizeof(SMMRMDeform),
+		sizeof(SMMRMDeformConstraint),
+		sizeof(vtx_idx),
+		MAX_STATOBJ_LODS_NUM,
+	};
+	return CCrc32::Compute(sizes, sizeof(sizes));
+}
+
+static uint32 GeomCacheFlags(const CStatObj* statObj)
+{
+	uint32 flags = 0;
+	if (Cry3DEngineBase::GetCVars()->e_MergedMeshesTesselationSupport)
+		flags |= MMRM_GEOMCACHE_TESSELATION;
+	if (!!CryStringUtils::stristr(statObj->m_szProperties, "mergedmesh_deform"))
+		flags |= MMRM_GEOMCACHE_DEFORM;
+	else if (statObj->m_nSpines && statObj->m_pSpines)
+		flags |= MMRM_GEOMCACHE_SPINES;
+	return flags;
+}
+
+static bool GeomCacheStampFile(const char* fileName, uint32& stamp, uint64& size)
+{
+	FILE* file = gEnv->pCryPak->FOpen(fileName, "rb");
+	if (!file)
+		return false;
+	const uint64 values[3] = { gEnv->pCryPak->GetModificationTime(file), gEnv->pCryPak->FGetSize(file), CCrc32::ComputeLowercase(fileName) };
+	gEnv->pCryPak->FClose(file);
+	stamp = CCrc32::Compute(values, sizeof(values), stamp);
+	size += values[1];
+	return true;
+}
+
+// Stamps the source cgf, every lod cgf and the material file, the cached geometry depends on all of them
+static bool GeomCacheSourceStamp(CStatObj* statObj, uint64& time, uint64& size)
+{
+	uint32 stamp = 0;
+	size = 0;
+	if (!GeomCacheStampFile(statObj->m_szFileName.c_str(), stamp, size))
+		return false;
+	for (int nLod = 1; nLod < (int)MAX_STATOBJ_LODS_NUM; ++nLod)
+	{
+		const CStatObj* lodObj = (CStatObj*)statObj->GetLodObject(nLod, false);
+		if (lodObj && lodObj != statObj && lodObj->m_szFileName != statObj->m_szFileName)
+		{
+			if (!GeomCacheStampFile(lodObj->m_szFileName.c_str(), stamp, size))
+				return false;
+		}
+	}
+	if (const IMaterial* material = statObj->GetMaterial())
+	{
+		// default and code created materials have no file, their name is still part of the stamp
+		const string materialFile = PathUtil::ReplaceExtension(material->GetName(), "mtl");
+		if (!GeomCacheStampFile(materialFile.c_str(), stamp, size))
+		{
+			const uint32 nameCrc = CCrc32::ComputeLowercase(materialFile.c_str());
+			stamp = CCrc32::Compute(&nameCrc, sizeof(nameCrc), stamp);
+		}
+	}
+	time = stamp;
+	return true;
+}
+
+static void GeomCachePath(const CStatObj* statObj, CryPathString& path)
+{
+	const string name = statObj->m_szFileName + "_" + statObj->m_szGeomName;
+	path.Format(MMRM_GEOMETRY_CACHE_FOLDER "/%08x_%08x.mmg"
+	            , CCrc32::ComputeLowercase(statObj->m_szFileName.c_str())
+	            , CCrc32::ComputeLowercase(name.c_str()));
+}
+
+class CGeomCacheWriter
+{
+	std::vector<uint8> m_data;
+
+public:
+	template<typename T> void Write(const T& value) { Write(&value, 1); }
+	template<typename T> void Write(const T* values, size_t count)
+	{
+		if (!count)
+			return;
+		const size_t offset = m_data.size();
+		m_data.resize(offset + count * sizeof(T));
+		memcpy(&m_data[offset], values, count * sizeof(T));
+	}
+
+	const uint8* Data() const { return m_data.empty() ? NULL : &m_data[0]; }
+	size_t       Size() const { return m_data.size(); }
+};
+
+class CGeomCacheReader
+{
+	const uint8* m_cur;
+	const uint8* m_end;
+
+public:
+	CGeomCacheReader(const uint8* data, size_t size) : m_cur(data), m_end(data + size) {}
+
+	template<typename T> bool Read(T& value) { return Read(&value, 1); }
+	template<typename T> bool Read(T* values, size_t count)
+	{
+		const size_t size = count * sizeof(T);
+		if ((size_t)(m_end - m_cur) < size)
+			return false;
+		memcpy(values, m_cur, size);
+		m_cur += size;
+		return true;
+	}
+	// Allocates the list the same way the preprocessing does and fills it
+	template<typename T> bool ReadList(T*& list, size_t count, size_t alloc, size_t align)
+	{
+		if (!alloc)
+			return true;
+		resize_list(list, alloc, align);
+		return Read(list, count);
+	}
+
+	bool AtEnd() const { return m_cur == m_end; }
+};
+
+// Builds the skinning vertices of a chunk from its baked vertex streams
+static void BuildSkinVertices(SMMRMChunk* chunk, size_t nalloc)
+{
+	resize_list(chunk->skin_vertices, nalloc, SMMRMSkinVertex_ALIGN);
+	for (size_t j = 0; j < chunk->nvertices; ++j)
+	{
+		memset(&chunk->skin_vertices[j], 0, sizeof(chunk->skin_vertices[j]));
+		chunk->skin_vertices[j].pos = chunk->general[j].xyz;
+		chunk->skin_vertices[j].uv = chunk->general[j].st;
+		chunk->skin_vertices[j].colour = chunk->general[j].color;
+		if (chunk->normals)
+			chunk->skin_vertices[j].normal = chunk->normals[j];
+		if (chunk->weights)
+		{
+			chunk->skin_vertices[j].SetWeights(chunk->weights[j].weights);
+			chunk->skin_vertices[j].SetBoneIds(chunk->weights[j].boneIds);
+		}
+		if (chunk->qtangents)
+			chunk->skin_vertices[j].qt = chunk->qtangents[j];
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Local geometry manager that contains the preprocessed geometry for the job
 class CGeometryManager : public Cry3DEngineBase
@@ -1193,6 +1939,12 @@ class CGeometryManager : public Cry3DEngineBase
 	// to perform quick&dirty deform sim
 	bool ExtractDeformLOD(SMMRMGeometry* geometry, CStatObj* host, size_t nLod);
 
+	// Restores the preprocessed geometry from the cache file of the statobj
+	bool LoadCachedGeometry(SMMRMGeometry* geometry, CStatObj* statObj);
+
+	// Writes the preprocessed geometry to the cache file of the statobj
+	void StoreCachedGeometry(const SMMRMGeometry* geometry, CStatObj* statObj);
+
 public:
 	CGeometryManager();
 	~CGeometryManager();
@@ -1654,23 +2406,7 @@ bool CGeometryManager::PrepareLOD(SMMRMGeometry* geometry, CStatObj* host, size_
 			geometry->numVtx += (chunk->nvertices_alloc = chunk->nvertices);
 			geometry->numIdx += (chunk->nindices_alloc = chunk->nindices);
 		}
-		resize_list(chunk->skin_vertices, nvertices, SMMRMSkinVertex_ALIGN);
-		for (size_t j = 0; j < chunk->nvertices; ++j)
-		{
-			memset(&chunk->skin_vertices[j], 0, sizeof(chunk->skin_vertices[j]));
-			chunk->skin_vertices[j].pos = chunk->general[j].xyz;
-			chunk->skin_vertices[j].uv = chunk->general[j].st;
-			chunk->skin_vertices[j].colour = chunk->general[j].color;
-			if (chunk->normals)
-				chunk->skin_vertices[j].normal = chunk->normals[j];
-			if (chunk->weights)
-			{
-				chunk->skin_vertices[j].SetWeights(chunk->weights[j].weights);
-				chunk->skin_vertices[j].SetBoneIds(chunk->weights[j].boneIds);
-			}
-			if (chunk->qtangents)
-				chunk->skin_vertices[j].qt = chunk->qtangents[j];
-		}
+		BuildSkinVertices(chunk, nvertices);
 	}
 
 	if (qtangents) CryModuleMemalignFree(qtangents);
@@ -1684,20 +2420,213 @@ bool CGeometryManager::PrepareLOD(SMMRMGeometry* geometry, CStatObj* host, size_
 	return true;
 }
 
-void CGeometryManager::PrepareGeometry(SMMRMGeometry* geometry)
+static void ResetCachedGeometry(SMMRMGeometry* geometry)
 {
-	if (!geometry)
-	{
-		return;
-	}
-	CStatObj* statObj = NULL;
-	if (geometry->is_obj)
-		statObj = geometry->srcObj;
-	else
-	{
-		statObj = GetStatObj(geometry);
-	}
-	if (!statObj)
+	for (size_t i = 0; i < MAX_STATOBJ_LODS_NUM; ++i)
+	{
+		for (size_t j = 0; j < geometry->numChunks[i]; ++j)
+		{
+			SMMRMChunk& chunk = geometry->pChunks[i][j];
+			CryModuleMemalignFree(chunk.general);
+			CryModuleMemalignFree(chunk.indices);
+			CryModuleMemalignFree(chunk.qtangents);
+			CryModuleMemalignFree(chunk.normals);
+			CryModuleMemalignFree(chunk.weights);
+			CryModuleMemalignFree(chunk.skin_vertices);
+		}
+		CryModuleMemalignFree(geometry->pChunks[i]);
+		geometry->pChunks[i] = NULL;
+		geometry->numChunks[i] = 0;
+	}
+	CryModuleMemalignFree(geometry->pSpineInfo);
+	CryModuleMemalignFree(geometry->pSpineVtx);
+	geometry->pSpineInfo = NULL;
+	geometry->pSpineVtx = NULL;
+	geometry->numSpines = geometry->numSpineVtx = 0;
+	SAFE_DELETE(geometry->deform);
+	geometry->numVtx = geometry->numIdx = 0;
+	geometry->maxSpinesPerVtx = 0;
+}
+
+bool CGeometryManager::LoadCachedGeometry(SMMRMGeometry* geometry, CStatObj* statObj)
+{
+	MEMORY_SCOPE_CHECK_HEAP();
+	SMergedMeshGeomCacheHeader header;
+	uint64 srcTime = 0, srcSize = 0;
+	if (!GeomCacheSourceStamp(statObj, srcTime, srcSize))
+		return false;
+
+	CryPathString path;
+	GeomCachePath(statObj, path);
+	FILE* file = gEnv->pCryPak->FOpen(path.c_str(), "rb");
+	if (!file)
+		return false;
+	std::vector<uint8> payload;
+	bool valid = gEnv->pCryPak->FReadRaw(&header, sizeof(header), 1, file) == 1
+	             && header.magic == c_MergedMeshGeomCacheMagic
+	             && header.version == c_MergedMeshGeomCacheVersion
+	             && header.layout == GeomCacheLayout()
+	             && header.flags == GeomCacheFlags(statObj)
+	             && header.srcTime == srcTime
+	             && header.srcSize == srcSize
+	             && header.payloadSize == gEnv->pCryPak->FGetSize(file) - sizeof(header);
+	if (valid && header.payloadSize)
+	{
+		payload.resize(header.payloadSize);
+		valid = gEnv->pCryPak->FReadRaw(&payload[0], 1, header.payloadSize, file) == header.payloadSize
+		        && CCrc32::Compute(&payload[0], header.payloadSize) == header.payloadCrc;
+	}
+	gEnv->pCryPak->FClose(file);
+	if (!valid || payload.empty())
+		return false;
+
+	CGeomCacheReader reader(&payload[0], payload.size());
+	uint32 numVtx = 0, numIdx = 0, maxSpinesPerVtx = 0;
+	valid = reader.Read(numVtx) && reader.Read(numIdx) && reader.Read(maxSpinesPerVtx) && reader.Read(geometry->aabb);
+	geometry->numVtx = numVtx;
+	geometry->numIdx = numIdx;
+	geometry->maxSpinesPerVtx = maxSpinesPerVtx;
+
+	for (size_t i = 0; valid && i < MAX_STATOBJ_LODS_NUM; ++i)
+	{
+		uint32 numChunks = 0;
+		if (!(valid = reader.Read(numChunks)) || !numChunks)
+			continue;
+		resize_list(geometry->pChunks[i], numChunks, 16);
+		for (size_t j = 0; valid && j < numChunks; ++j)
+		{
+			uint32 matId = 0, counts[4] = { 0 }, streams = 0;
+			if (!(valid = reader.Read(matId) && reader.Read(counts, 4) && reader.Read(streams)))
+				break;
+			SMMRMChunk* chunk = new(&geometry->pChunks[i][geometry->numChunks[i]++])SMMRMChunk(matId);
+			chunk->nvertices = counts[0];
+			chunk->nindices = counts[1];
+			chunk->nvertices_alloc = counts[2];
+			chunk->nindices_alloc = counts[3];
+			valid = reader.ReadList(chunk->general, chunk->nvertices, chunk->nvertices, 16)
+			        && reader.ReadList(chunk->indices, chunk->nindices, chunk->nindices, 16)
+			        && reader.ReadList(chunk->qtangents, chunk->nvertices, (streams & BIT(0)) ? chunk->nvertices : 0, 16)
+			        && reader.ReadList(chunk->normals, chunk->nvertices, (streams & BIT(1)) ? chunk->nvertices : 0, 16)
+			        && reader.ReadList(chunk->weights, chunk->nvertices, (streams & BIT(2)) ? chunk->nvertices : 0, 16);
+			if (valid)
+				BuildSkinVertices(chunk, chunk->nvertices);
+		}
+	}
+
+	uint32 numSpines = 0, numSpineVtx = 0;
+	valid = valid && reader.Read(numSpines) && reader.Read(numSpineVtx);
+	if (valid && numSpines)
+	{
+		geometry->numSpines = numSpines;
+		geometry->numSpineVtx = numSpineVtx;
+		valid = reader.ReadList(geometry->pSpineInfo, numSpines, numSpines, 16)
+		        && reader.ReadList(geometry->pSpineVtx, numSpineVtx, numSpineVtx, 16);
+	}
+
+	uint8 hasDeform = 0;
+	valid = valid && reader.Read(hasDeform);
+	if (valid && hasDeform)
+	{
+		uint32 counts[3] = { 0 };
+		SMMRMDeform* deform = geometry->deform = new SMMRMDeform();
+		valid = reader.Read(counts, 3);
+		deform->nvertices = counts[0];
+		deform->nconstraints = counts[1];
+		valid = valid
+		        && reader.ReadList(deform->initial, deform->nvertices, deform->nvertices, 16)
+		        && reader.ReadList(deform->invmass, deform->nvertices, deform->nvertices, 16)
+		        && reader.ReadList(deform->mapping, counts[2], counts[2], 16)
+		        && reader.ReadList(deform->constraints, deform->nconstraints, deform->nconstraints, 16);
+	}
+
+	if (!valid || !reader.AtEnd())
+	{
+		CryWarning(VALIDATOR_MODULE_3DENGINE, VALIDATOR_WARNING, "MMRM geometry cache '%s' is corrupt, preprocessing '%s'", path.c_str(), statObj->m_szFileName.c_str());
+		ResetCachedGeometry(geometry);
+		return false;
+	}
+	return true;
+}
+
+void CGeometryManager::StoreCachedGeometry(const SMMRMGeometry* geometry, CStatObj* statObj)
+{
+	SMergedMeshGeomCacheHeader header;
+	if (!GeomCacheSourceStamp(statObj, header.srcTime, header.srcSize))
+		return;
+
+	CGeomCacheWriter writer;
+	writer.Write((uint32)geometry->numVtx);
+	writer.Write((uint32)geometry->numIdx);
+	writer.Write((uint32)geometry->maxSpinesPerVtx);
+	writer.Write(geometry->aabb);
+	for (size_t i = 0; i < MAX_STATOBJ_LODS_NUM; ++i)
+	{
+		writer.Write((uint32)geometry->numChunks[i]);
+		for (size_t j = 0; j < geometry->numChunks[i]; ++j)
+		{
+			const SMMRMChunk& chunk = geometry->pChunks[i][j];
+			const uint32 counts[4] = { (uint32)chunk.nvertices, (uint32)chunk.nindices, (uint32)chunk.nvertices_alloc, (uint32)chunk.nindices_alloc };
+			const uint32 streams = (chunk.qtangents ? BIT(0) : 0) | (chunk.normals ? BIT(1) : 0) | (chunk.weights ? BIT(2) : 0);
+			writer.Write((uint32)chunk.matId);
+			writer.Write(counts, 4);
+			writer.Write(streams);
+			writer.Write(chunk.general, chunk.nvertices);
+			writer.Write(chunk.indices, chunk.nindices);
+			if (chunk.qtangents) writer.Write(chunk.qtangents, chunk.nvertices);
+			if (chunk.normals) writer.Write(chunk.normals, chunk.nvertices);
+			if (chunk.weights) writer.Write(chunk.weights, chunk.nvertices);
+		}
+	}
+	writer.Write((uint32)geometry->numSpines);
+	writer.Write((uint32)geometry->numSpineVtx);
+	if (geometry->numSpines)
+	{
+		writer.Write(geometry->pSpineInfo, geometry->numSpines);
+		writer.Write(geometry->pSpineVtx, geometry->numSpineVtx);
+	}
+	writer.Write((uint8)(geometry->deform != NULL));
+	if (const SMMRMDeform* deform = geometry->deform)
+	{
+		const uint32 counts[3] = { (uint32)deform->nvertices, (uint32)deform->nconstraints, (uint32)geometry->numVtx };
+		writer.Write(counts, 3);
+		writer.Write(deform->initial, deform->nvertices);
+		writer.Write(deform->invmass, deform->nvertices);
+		writer.Write(deform->mapping, geometry->numVtx);
+		writer.Write(deform->constraints, deform->nconstraints);
+	}
+
+	header.magic = c_MergedMeshGeomCacheMagic;
+	header.version = c_MergedMeshGeomCacheVersion;
+	header.layout = GeomCacheLayout();
+	header.flags = GeomCacheFlags(statObj);
+	header.payloadSize = (uint32)writer.Size();
+	header.payloadCrc = CCrc32::Compute(writer.Data(), writer.Size());
+
+	CryPathString path;
+	GeomCachePath(statObj, path);
+	gEnv->pCryPak->MakeDir(MMRM_GEOMETRY_CACHE_FOLDER);
+	if (FILE* file = gEnv->pCryPak->FOpen(path.c_str(), "wb"))
+	{
+		gEnv->pCryPak->FWrite(&header, sizeof(header), 1, file);
+		gEnv->pCryPak->FWrite(writer.Data(), 1, writer.Size(), file);
+		gEnv->pCryPak->FClose(file);
+	}
+}
+
+void CGeometryManager::PrepareGeometry(SMMRMGeometry* geometry)
+{
+	if (!geometry)
+	{
+		return;
+	}
+	CStatObj* statObj = NULL;
+	if (geometry->is_obj)
+		statObj = geometry->srcObj;
+	else
+	{
+		statObj = GetStatObj(geometry);
+	}
+	if (!statObj)
 	{
 		geometry->state = SMMRMGeometry::NO_STATINSTGROUP;
 		return;
@@ -1706,7 +2635,8 @@ void CGeometryManager::PrepareGeometry(SMMRMGeometry* geometry)
 	float maxSpineLen = 0, len = 0;
 	int i = 0, j = 0;
 	size_t resultingSize = 0;
-	for (i = 0; success && i < (int)MAX_STATOBJ_LODS_NUM; ++i)
+	const bool cached = e_MergedMeshesGeometryCache > 0 && LoadCachedGeometry(geometry, statObj);
+	for (i = 0; !cached && success && i < (int)MAX_STATOBJ_LODS_NUM; ++i)
 	{
 		bool bResubmit = false;
 		success &= PrepareLOD(geometry, statObj, i, bResubmit);
@@ -1722,7 +2652,11 @@ void CGeometryManager::PrepareGeometry(SMMRMGeometry* geometry)
 			return;
 		}
 	}
-	if (!!CryStringUtils::stristr(statObj->m_szProperties, "mergedmesh_deform"))
+	if (cached)
+	{
+		// chunks, spines and deform data have been restored from the cache
+	}
+	else if (!!CryStringUtils::stristr(statObj->m_szProperties, "mergedmesh_deform"))
 	{
 		success &= ExtractDeformLOD(geometry, statObj, 0);
 	}
@@ -1769,11 +2703,17 @@ void CGeometryManager::PrepareGeometry(SMMRMGeometry* geometry)
 		resultingSize = geometry->Size() + sizeof(SMMRMGeometry);
 		m_PreprocessedSize += resultingSize;
 
+		if (!cached && e_MergedMeshesGeometryCache == 1)
+		{
+			StoreCachedGeometry(geometry, statObj);
+		}
+
 		if (GetCVars()->e_DebugGeomPrep > 0)
 		{
 			string szGeomName = statObj->m_szFileName + "_" + statObj->m_szGeomName;
-			CryLogAlways("PVRN geometry '%s' prepared, size %" PRISIZE_T " bytes"
+			CryLogAlways("PVRN geometry '%s' %s, size %" PRISIZE_T " bytes"
 			             , (szGeomName.c_str() ? szGeomName.c_str() : "unknown")
+			             , cached ? "loaded from cache" : "prepared"
 			             , resultingSize);
 			for (i = 0; i < (int)MAX_STATOBJ_LODS_NUM; ++i)
 			{
@@ -1990,6 +2930,7 @@ CMergedMeshRenderNode::CMergedMeshRenderNode()
 	, m_RenderMode(NOT_VISIBLE)
 	, m_wind()
 	, m_density()
+	, m_densityMips()
 	, m_Colliders()
 	, m_nColliders()
 	, m_Projectiles()
@@ -2060,7 +3001,7 @@ void CMergedMeshRenderNode::Clear()
 	m_groups = NULL;
 	m_nGroups = 0u;
 	if (m_wind) { CryModuleMemalignFree(m_wind); m_wind = NULL; }
-	if (m_density) { CryModuleMemalignFree(m_density); m_density = NULL; }
+	FreeDensity();
 	if (m_Colliders) { CryModuleMemalignFree(m_Colliders); m_Colliders = NULL; }
 	if (m_Projectiles) { CryModuleMemalignFree(m_Projectiles); m_Projectiles = NULL; }
 }
@@ -2391,12 +3332,14 @@ size_t CMergedMeshRenderNode::RemoveInstance(size_t headerIndex, size_t instance
 
 void CMergedMeshRenderNode::QueryColliders()
 {
-	::QueryColliders(m_Colliders, m_nColliders, m_visibleAABB);
+	if (!s_Broadphase.QueryColliders(m_Colliders, m_nColliders, m_visibleAABB))
+		::QueryColliders(m_Colliders, m_nColliders, m_visibleAABB);
 }
 
 void CMergedMeshRenderNode::QueryProjectiles()
 {
-	::QueryProjectiles(m_Projectiles, m_nProjectiles, m_visibleAABB);
+	if (!s_Broadphase.QueryProjectiles(m_Projectiles, m_nProjectiles, m_visibleAABB))
+		::QueryProjectiles(m_Projectiles, m_nProjectiles, m_visibleAABB);
 }
 
 void CMergedMeshRenderNode::SampleWind()
@@ -2404,6 +3347,167 @@ void CMergedMeshRenderNode::SampleWind()
 	::SampleWind(m_wind, m_internalAABB);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Density pyramid
+//
+// Level 0 stores for every cell of the MMRM_DENSITY_DIM grid the highest summed
+// density of the samples of the cell and of its direct neighbours. Interpolating
+// the samples never exceeds that, so it bounds the density anywhere inside the
+// cell. Every further level stores the maximum of 2x2x2 cells of the level
+// below, down to a single cell covering the whole node. Queries in empty space
+// are answered from it without touching the density samples.
+//
+// The pyramid is built from the samples, published and freed under
+// s_DensityMipsLock, and the samples are only freed under it as well.
+static_assert((MMRM_DENSITY_DIM & (MMRM_DENSITY_DIM - 1)) == 0, "the density pyramid needs a power of two density grid");
+
+static CryCriticalSection s_DensityMipsLock;
+
+struct SMMRMDensityMips
+{
+	enum { MaxLevels = 8 };
+
+	const SSampleDensity* source;
+	size_t                numLevels;
+	size_t                offsets[MaxLevels];
+	std::vector<float>    values;
+
+	SMMRMDensityMips() : source(), numLevels(), offsets() {}
+
+	static int  Dim(size_t level) { return MMRM_DENSITY_DIM >> level; }
+	float&      Cell(size_t level, int x, int y, int z)       { return values[offsets[level] + x + (y + z * Dim(level)) * Dim(level)]; }
+	float       Cell(size_t level, int x, int y, int z) const { return values[offsets[level] + x + (y + z * Dim(level)) * Dim(level)]; }
+
+	void Allocate()
+	{
+		size_t size = 0;
+		for (numLevels = 0; numLevels < MaxLevels && Dim(numLevels) > 0; ++numLevels)
+		{
+			offsets[numLevels] = size;
+			size += cube(Dim(numLevels));
+		}
+		values.resize(size, 0.f);
+	}
+
+	// Maximum over the level 0 cells in [lo, hi]
+	float QueryMax(int (&lo)[3], int (&hi)[3]) const
+	{
+		// Coarsen until at most two cells per axis have to be visited
+		size_t level = 0;
+		while (level + 1 < numLevels && (hi[0] - lo[0] > 1 || hi[1] - lo[1] > 1 || hi[2] - lo[2] > 1))
+		{
+			++level;
+			for (int a = 0; a < 3; ++a)
+			{
+				lo[a] >>= 1;
+				hi[a] >>= 1;
+			}
+		}
+		float result = 0.f;
+		for (int z = lo[2]; z <= hi[2]; ++z)
+			for (int y = lo[1]; y <= hi[1]; ++y)
+				for (int x = lo[0]; x <= hi[0]; ++x)
+					result = max(result, Cell(level, x, y, z));
+		return result;
+	}
+};
+
+const SMMRMDensityMips* CMergedMeshRenderNode::DensityMips()
+{
+	if (!m_density)
+		return NULL;
+	if (m_densityMips && m_densityMips->source == m_density)
+		return m_densityMips;
+
+	FUNCTION_PROFILER_3DENGINE;
+	const int dim = MMRM_DENSITY_DIM;
+
+	// Summed density of all surface types per sample
+	std::vector<float> sums(cube(dim), 0.f);
+	for (size_t i = 0, n = sums.size(); i < n; ++i)
+	{
+		uint32 sum = 0;
+		for (size_t j = 0; j < MMRM_MAX_SURFACE_TYPES; ++j)
+			sum += m_density[i].density_u8[j];
+		sums[i] = sum * (1.f / 255.f);
+	}
+
+	// Maximum over the direct neighbours, one axis at a time
+	std::vector<float> neighbours(sums.size());
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const int stride = axis == 0 ? 1 : axis == 1 ? dim : dim * dim;
+		for (int z = 0; z < dim; ++z)
+			for (int y = 0; y < dim; ++y)
+				for (int x = 0; x < dim; ++x)
+				{
+					const int c = axis == 0 ? x : axis == 1 ? y : z;
+					const int i = x + (y + z * dim) * dim;
+					float highest = sums[i];
+					if (c > 0) highest = max(highest, sums[i - stride]);
+					if (c < dim - 1) highest = max(highest, sums[i + stride]);
+					neighbours[i] = highest;
+				}
+		sums.swap(neighbours);
+	}
+
+	SMMRMDensityMips* mips = new SMMRMDensityMips;
+	mips->Allocate();
+	memcpy(&mips->values[mips->offsets[0]], &sums[0], sums.size() * sizeof(float));
+	for (size_t level = 1; level < mips->numLevels; ++level)
+	{
+		const int ldim = SMMRMDensityMips::Dim(level);
+		for (int z = 0; z < ldim; ++z)
+			for (int y = 0; y < ldim; ++y)
+				for (int x = 0; x < ldim; ++x)
+				{
+					float highest = 0.f;
+					for (int c = 0; c < 8; ++c)
+						highest = max(highest, mips->Cell(level - 1, x * 2 + (c & 1), y * 2 + ((c >> 1) & 1), z * 2 + (c >> 2)));
+					mips->Cell(level, x, y, z) = highest;
+				}
+	}
+	mips->source = m_density;
+
+	delete m_densityMips;
+	return m_densityMips = mips;
+}
+
+float CMergedMeshRenderNode::QueryDensityMax(const AABB& box)
+{
+	if (!m_internalAABB.IsIntersectBox(box))
+		return 0.f;
+
+	AUTO_LOCK(s_DensityMipsLock);
+	const SMMRMDensityMips* mips = DensityMips();
+	if (!mips)
+		return 0.f;
+	const Vec3 size = m_internalAABB.GetSize();
+	int lo[3], hi[3];
+	for (int a = 0; a < 3; ++a)
+	{
+		const float scale = MMRM_DENSITY_DIM / max(size[a], FLT_EPSILON);
+		lo[a] = clamp_tpl((int)((box.min[a] - m_internalAABB.min[a]) * scale), 0, MMRM_DENSITY_DIM - 1);
+		hi[a] = clamp_tpl((int)((box.max[a] - m_internalAABB.min[a]) * scale), 0, MMRM_DENSITY_DIM - 1);
+	}
+	return mips->QueryMax(lo, hi);
+}
+
+void CMergedMeshRenderNode::ResetDensityMips()
+{
+	AUTO_LOCK(s_DensityMipsLock);
+	delete m_densityMips;
+	m_densityMips = NULL;
+}
+
+void CMergedMeshRenderNode::FreeDensity()
+{
+	AUTO_LOCK(s_DensityMipsLock);
+	if (m_density) { CryModuleMemalignFree(m_density); m_density = NULL; }
+	delete m_densityMips;
+	m_densityMips = NULL;
+}
+
 bool CMergedMeshRenderNode::DeleteRenderMesh(RENDERMESH_UPDATE_TYPE type, bool block, bool zap)
 {
 	MEMORY_SCOPE_CHECK_HEAP();
@@ -2422,6 +3526,8 @@ bool CMergedMeshRenderNode::DeleteRenderMesh(RENDERMESH_UPDATE_TYPE type, bool b
 			for (size_t i = 0; i < renderMeshes[j].updates.size(); ++i)
 				renderMeshes[j].updates[i].chunks.clear();
 		}
+		for (size_t i = 0; i < renderMeshes[j].rms.size(); ++i)
+			s_RenderMeshPool.Release(renderMeshes[j].rms[i], s_mmrm_globals.frameId);
 		if (zap)
 			stl::free_container(renderMeshes[j].rms);
 		else
@@ -2582,13 +3688,10 @@ done:
 				rmchunks.push_back(chunk);
 
 			mmrm_assert(iv <= 0xffff);
-			// Create a new rendermesh and dispatch the asynchronous updates
-			_smart_ptr<IRenderMesh> rm = GetRenderer()->CreateRenderMeshInitialized(
-			  NULL, iv, EDefaultInputLayouts::P3S_C4B_T2S, NULL, ii,
-			  prtTriangleList, "MergedMesh", "MergedMesh", eRMT_Dynamic);
+			// Fetch a pooled rendermesh and dispatch the asynchronous updates
+			_smart_ptr<IRenderMesh> rm = s_RenderMeshPool.Acquire(iv, ii, passInfo.GetMainFrameID());
 			rm->LockForThreadAccess();
-			m_SizeInVRam += (sizeof(SVF_P3S_C4B_T2S) + sizeof(SPipTangents)) * iv;
-			m_SizeInVRam += sizeof(vtx_idx) * ii;
+			m_SizeInVRam += CMergedMeshRenderMeshPool::SizeInVram(rm->GetVerticesCount(), rm->GetIndicesCount());
 
 			strided_pointer<SPipTangents> tgtBuf;
 			strided_pointer<Vec3f16> vtxBuf;
@@ -2610,6 +3713,7 @@ done:
 				rm->UnlockStream(VSF_TANGENTS);
 				rm->UnlockIndexStream();
 				rm->UnLockForThreadAccess();
+				s_RenderMeshPool.Release(rm, passInfo.GetMainFrameID());
 				continue;
 			}
 			for (size_t j = beg; j < k; ++j)
@@ -3038,10 +4142,29 @@ bool CMergedMeshRenderNode::PostRender(const SRenderingPassInfo& passInfo)
 	return false;
 }
 
+static void GetCompressedInstances(const SMMRMGroupHeader* header, PodArray<SMergedMeshInstanceCompressed>& samples)
+{
+	samples.resize(header->numSamples);
+	for (size_t j = 0; j < header->numSamples; ++j)
+	{
+		SMergedMeshInstanceCompressed& sampleChunk = samples[j];
+		sampleChunk.pos_x = header->instances[j].pos_x;
+		sampleChunk.pos_y = header->instances[j].pos_y;
+		sampleChunk.pos_z = header->instances[j].pos_z;
+		sampleChunk.rot[0] = header->instances[j].qx;
+		sampleChunk.rot[1] = header->instances[j].qy;
+		sampleChunk.rot[2] = header->instances[j].qz;
+		sampleChunk.rot[3] = header->instances[j].qw;
+		sampleChunk.scale = header->instances[j].scale;
+	}
+}
+
 bool CMergedMeshRenderNode::Compile(byte* pData, int& nSize, string* pName, std::vector<struct IStatInstGroup*>* pVegGroupTable, const Vec3& segmentOffset)
 {
 	// Construct the unique id for the sector
 	const float fExtentsRec = 1.0f / c_MergedMeshesExtent;
+	PodArray<SMergedMeshInstanceCompressed> samples;
+	std::vector<uint8> stream;
 	if (pData)
 	{
 		char token[256];
@@ -3068,21 +4191,25 @@ bool CMergedMeshRenderNode::Compile(byte* pData, int& nSize, string* pName, std:
 			sectorChunk.i = (uint32)floorf(abs(m_pos.x + segmentOffset.x) * fExtentsRec);
 			sectorChunk.j = (uint32)floorf(abs(m_pos.y + segmentOffset.y) * fExtentsRec);
 			sectorChunk.k = (uint32)floorf(abs(m_pos.z + segmentOffset.z) * fExtentsRec);
-			sectorChunk.ver = c_MergedMeshChunkVersion;
+			sectorChunk.ver = e_MergedMeshesPackedSectors ? c_MergedMeshPackedChunkVersion : c_MergedMeshChunkVersion;
 			AddToPtr(pPtr, sectorChunk, GetPlatformEndian());
 
-			for (size_t j = 0; j < header->numSamples; ++j)
+			GetCompressedInstances(header, samples);
+			if (e_MergedMeshesPackedSectors)
 			{
-				SMergedMeshInstanceCompressed sampleChunk;
-				sampleChunk.pos_x = header->instances[j].pos_x;
-				sampleChunk.pos_y = header->instances[j].pos_y;
-				sampleChunk.pos_z = header->instances[j].pos_z;
-				sampleChunk.rot[0] = header->instances[j].qx;
-				sampleChunk.rot[1] = header->instances[j].qy;
-				sampleChunk.rot[2] = header->instances[j].qz;
-				sampleChunk.rot[3] = header->instances[j].qw;
-				sampleChunk.scale = header->instances[j].scale;
-				AddToPtr(pPtr, sampleChunk, GetPlatformEndian());
+				stream.clear();
+				PackSectorInstances(samples.GetElements(), samples.size(), stream);
+				const uint32 streamSize = (uint32)stream.size();
+				for (int b = 0; b < 4; ++b)
+					*pPtr++ = (uint8)(streamSize >> (b * 8));
+				if (streamSize)
+					memcpy(pPtr, &stream[0], streamSize);
+				pPtr += streamSize;
+			}
+			else
+			{
+				for (size_t j = 0; j < header->numSamples; ++j)
+					AddToPtr(pPtr, samples[j], GetPlatformEndian());
 			}
 		}
 	}
@@ -3091,7 +4218,15 @@ bool CMergedMeshRenderNode::Compile(byte* pData, int& nSize, string* pName, std:
 		for (size_t i = 0; i < NumGroups(); ++i)
 		{
 			nSize += sizeof(SMergedMeshSectorChunk);
-			nSize += Group(i)->numSamples * sizeof(SMergedMeshInstanceCompressed);
+			if (e_MergedMeshesPackedSectors)
+			{
+				stream.clear();
+				GetCompressedInstances(Group(i), samples);
+				PackSectorInstances(samples.GetElements(), samples.size(), stream);
+				nSize += 4 + (int)stream.size();
+			}
+			else
+				nSize += Group(i)->numSamples * sizeof(SMergedMeshInstanceCompressed);
 		}
 	}
 
@@ -3190,6 +4325,21 @@ void CMergedMeshRenderNode::StreamAsyncOnComplete(IReadStream* pStream, unsigned
 		return;
 	}
 
+	// Packed sectors are expanded here on the streaming thread, the samples
+	// are then initialized synchronously as the expanded data is local
+	std::vector<uint8> unpacked;
+	if (nSize >= sizeof(uint32) && PackedGet32(pBuffer) == c_MergedMeshPackedChunkVersion)
+	{
+		if (!UnpackSector(pBuffer, nSize, unpacked) || unpacked.empty())
+		{
+			CryLogAlways("ERRROR: corrupt packed pvrn sector found, please re-export level!");
+			m_State = RENDERNODE_STATE_ERROR;
+			return;
+		}
+		pBuffer = &unpacked[0];
+	}
+	const uint8* pSamples = pBuffer;
+
 	for (size_t i = 0; i < NumGroups(); ++i)
 	{
 		SMMRMGroupHeader* header = &m_groups[i];
@@ -3225,7 +4375,13 @@ void CMergedMeshRenderNode::StreamAsyncOnComplete(IReadStream* pStream, unsigned
 		stepcount += header->numSamples;
 	}
 
-	TMergedMesh_InitializeSamples job(c_MergedMeshesExtent, reinterpret_cast<const uint8*>(pStream->GetBuffer()));
+	if (!unpacked.empty())
+	{
+		InitializeSamples(c_MergedMeshesExtent, pSamples);
+		return;
+	}
+
+	TMergedMesh_InitializeSamples job(c_MergedMeshesExtent, pSamples);
 	job.SetPriorityLevel(JobManager::eLowPriority);
 	job.SetClassInstance(this);
 	job.Run();
@@ -3309,7 +4465,7 @@ bool CMergedMeshRenderNode::StreamOut()
 			header->instances = NULL;
 		}
 		if (m_wind) { CryModuleMemalignFree(m_wind); m_wind = NULL; }
-		if (m_density) { CryModuleMemalignFree(m_density); m_density = NULL; }
+		FreeDensity();
 		if (m_Colliders) { CryModuleMemalignFree(m_Colliders); m_Colliders = NULL; }
 		m_SpinesActive = false;
 		return true;
@@ -3671,11 +4827,17 @@ void CMergedMeshRenderNode::UpdateStreamingPriority(const SUpdateStreamingPriori
 				m_usedMaterials.push_back(std::make_pair(material, pObj));
 		}
 	}
+	// Precache as if the camera already was at its predicted position when
+	// this node lies on the path ahead of it
+	float distance = context.distance;
+	const CMergedMeshesManager::SStreamingCamera camera = m_pMergedMeshesManager->GetStreamingCamera();
+	if (camera.bPredicting)
+		distance = min(distance, sqrt_tpl(Distance::Point_AABBSq(camera.predictedPos, m_visibleAABB)));
 	for (size_t i = 0; i < m_usedMaterials.size(); ++i)
 	{
 		pObjManager->PrecacheStatObjMaterial(
 		  m_usedMaterials[i].first
-		  , context.distance
+		  , distance
 		  , m_usedMaterials[i].second
 		  , context.bFullUpdate, false);
 	}
@@ -3764,6 +4926,290 @@ CMergedMeshInstanceProxy::~CMergedMeshInstanceProxy()
 	}
 }
 
+#if !defined(_RELEASE)
+//////////////////////////////////////////////////////////////////////////
+// e_MergedMeshesBenchmark: headless benchmark of the merged mesh simulation
+//
+// Scatters a reproducible random set of instances of one vegetation group over
+// a synthetic sector and runs culling, spine simulation and deform merging
+// through the regular job entry points. Vertices are merged into system memory
+// buffers, so neither the renderer nor the physics are involved.
+struct SMMRMBenchmarkGroup
+{
+	SMMRMGroupHeader              header;
+	SMMRMUpdateContext            update;
+	std::vector<SVF_P3S_C4B_T2S>  general;
+	std::vector<SPipTangents>     tangents;
+	std::vector<Vec3f16>          normals;
+	std::vector<vtx_idx>          indices;
+	volatile int                  updateState;
+
+	SMMRMBenchmarkGroup() : header(), update(), updateState() {}
+};
+
+struct SMMRMBenchmarkTimer
+{
+	int64 ticks;
+	SMMRMBenchmarkTimer() : ticks() {}
+	double Milliseconds() const { return double(ticks) * 1e3 / double(CryGetTicksPerSec()); }
+	double NsPer(uint64 count) const { return count ? double(ticks) * 1e9 / double(CryGetTicksPerSec()) / double(count) : 0.0; }
+};
+
+// Usage: e_MergedMeshesBenchmark <statInstGroupId> [instances] [frames] [seed]
+static void MergedMeshesBenchmarkCmd(IConsoleCmdArgs* pArgs)
+{
+	if (pArgs->GetArgCount() < 2)
+	{
+		CryLogAlways("Usage: e_MergedMeshesBenchmark <statInstGroupId> [instances] [frames] [seed]");
+		return;
+	}
+	const int groupId = atoi(pArgs->GetArg(1));
+	const int numInstances = pArgs->GetArgCount() > 2 ? max(atoi(pArgs->GetArg(2)), 1) : 4096;
+	const int numFrames = pArgs->GetArgCount() > 3 ? max(atoi(pArgs->GetArg(3)), 1) : 100;
+	const uint32 seed = pArgs->GetArgCount() > 4 ? (uint32)atoi(pArgs->GetArg(4)) : 0x4d4d524du;
+
+	if (groupId < 0 || groupId >= (int)Cry3DEngineBase::GetObjManager()->m_lstStaticTypes.size()
+	    || !Cry3DEngineBase::GetObjManager()->m_lstStaticTypes[groupId].GetStatObj())
+	{
+		CryLogAlways("e_MergedMeshesBenchmark: %d is not a valid vegetation group", groupId);
+		return;
+	}
+	StatInstGroup& srcGroup = Cry3DEngineBase::GetObjManager()->m_lstStaticTypes[groupId];
+
+	// The geometry is preprocessed the same way as for streamed sectors
+	SMMRMGeometry* geom = s_GeomManager.GetGeometry(groupId);
+	gEnv->pJobManager->WaitForJob(geom->geomPrepareState);
+	if (geom->state != SMMRMGeometry::PREPARED)
+	{
+		CryLogAlways("e_MergedMeshesBenchmark: geometry of group %d could not be prepared for merging", groupId);
+		s_GeomManager.ReleaseGeometry(geom);
+		return;
+	}
+
+	size_t lodVertices = 0, lodIndices = 0;
+	for (size_t j = 0; j < geom->numChunks[0]; ++j)
+	{
+		lodVertices += geom->pChunks[0][j].nvertices;
+		lodIndices += geom->pChunks[0][j].nindices;
+	}
+	const size_t batch = max((size_t)1, min((size_t)MMRM_MAX_SAMPLES_PER_BATCH, 0xffffu / max(lodVertices, (size_t)1)));
+	const size_t numGroups = (numInstances + batch - 1) / batch;
+
+	const AABB bounds(Vec3(0.f, 0.f, 0.f), Vec3(c_MergedMeshesExtent, c_MergedMeshesExtent, c_MergedMeshesExtent));
+	Vec3 origin = bounds.min, centre = bounds.GetCenter();
+	const float fExtentsRec = 1.0f / c_MergedMeshesExtent;
+
+	CRndGen rng(seed);
+	std::vector<SMMRMBenchmarkGroup*> groups(numGroups);
+	uint64 spineVertices = 0, deformVertices = 0;
+	for (size_t i = 0, remaining = numInstances; i < numGroups; ++i)
+	{
+		SMMRMBenchmarkGroup* group = groups[i] = new SMMRMBenchmarkGroup;
+		SMMRMGroupHeader* header = &group->header;
+		header->procGeom = i ? s_GeomManager.GetGeometry(groupId) : geom;
+		header->instGroupId = groupId;
+		header->maxViewDistance = srcGroup.fVegRadius * srcGroup.fMaxViewDistRatio * 100.f;
+		header->lodRationNorm = srcGroup.fLodDistRatio;
+		header->is_dynamic = geom->numSpines > 0u || geom->deform;
+		header->physConfig.Update(&srcGroup, 1.f);
+		resize_list(header->instances, header->numSamplesAlloc = header->numSamples = min(remaining, batch), 128);
+		resize_list(header->visibleChunks, header->numVisbleChunks = geom->numChunks[0], 16);
+		remaining -= header->numSamples;
+
+		for (size_t j = 0; j < header->numSamples; ++j)
+		{
+			const Vec3 pos(
+			  rng.GetRandom(bounds.min.x, bounds.max.x),
+			  rng.GetRandom(bounds.min.y, bounds.max.y),
+			  bounds.min.z);
+			ConvertInstanceRelative(header->instances[j], pos, origin, fExtentsRec);
+			CompressQuat(Quat::CreateRotationZ(rng.GetRandom(0.f, gf_PI2)), header->instances[j]);
+			header->instances[j].scale = (uint8)SATURATEB(rng.GetRandom(0.8f, 1.2f) * VEGETATION_CONV_FACTOR);
+			header->instances[j].lastLod = -2;
+		}
+
+		// Spines start in their rest pose with a random push, so the first
+		// frames already have to resolve motion
+		if (geom->numSpines)
+		{
+			resize_list(header->spines, header->numSamples * geom->numSpineVtx, 128);
+			for (size_t j = 0, base = 0; j < header->numSamples; ++j)
+			{
+				Quat q;
+				const float fScale = (1.f / VEGETATION_CONV_FACTOR) * header->instances[j].scale;
+				DecompressQuat(q, header->instances[j]);
+				Matrix34 wmat = CreateRotationQ(q, ConvertInstanceAbsolute(header->instances[j], origin, centre, 0.f, c_MergedMeshesExtent));
+				for (size_t k = 0; k < geom->numSpineVtx; ++k, ++base)
+				{
+#if MMRM_SIMULATION_USES_FP32
+					header->spines[base].pt = wmat * (geom->pSpineVtx[k].pt * fScale);
+					header->spines[base].vel = rng.GetRandom(Vec3(-1.f, -1.f, 0.f), Vec3(1.f, 1.f, 0.f));
+#else
+					header->spines[base].pt = geom->pSpineVtx[k].pt;
+					header->spines[base].vel = Vec3(0, 0, 0);
+#endif
+				}
+			}
+			spineVertices += header->numSamples * geom->numSpineVtx;
+		}
+		if (geom->deform)
+		{
+			resize_list(header->deform_vertices, header->numSamples * geom->deform->nvertices, 16);
+			for (size_t j = 0, base = 0; j < header->numSamples; ++j)
+			{
+				Quat q;
+				const float fScale = (1.f / VEGETATION_CONV_FACTOR) * header->instances[j].scale;
+				DecompressQuat(q, header->instances[j]);
+				Matrix34 wmat = CreateRotationQ(q, ConvertInstanceAbsolute(header->instances[j], origin, centre, 0.f, c_MergedMeshesExtent)) * Matrix34::CreateScale(Vec3(fScale, fScale, fScale));
+				for (size_t k = 0; k < geom->deform->nvertices; ++k, ++base)
+				{
+					header->deform_vertices[base].pos[0] = header->deform_vertices[base].pos[1] = wmat * geom->deform->initial[k];
+					header->deform_vertices[base].vel = Vec3(0, 0, 0);
+				}
+			}
+			deformVertices += header->numSamples * geom->deform->nvertices;
+		}
+
+		group->general.resize(header->numSamples * lodVertices);
+		group->tangents.resize(header->numSamples * lodVertices);
+		group->normals.resize(header->numSamples * lodVertices);
+		group->indices.resize(header->numSamples * lodIndices);
+	}
+
+	// Looking straight down onto the sector from above, so the whole sector is
+	// inside the frustum and frustum culling still has to test every instance
+	CCamera camera;
+	camera.SetMatrix(Matrix34(Matrix33::CreateRotationX(-gf_PI * 0.5f), centre + Vec3(0.f, 0.f, c_MergedMeshesExtent)));
+	camera.SetFrustum(1024, 1024, DEG2RAD(100.f), 0.25f, 1024.f);
+
+	// Procedural wind field with a travelling gust
+	Vec3* wind = NULL;
+	resize_list(wind, cube(MMRM_WIND_DIM), 16);
+
+	SMMRMBenchmarkTimer cullTimer, updateTimer;
+	uint64 mergedVertices = 0;
+	const float dt = 1.f / 30.f;
+	for (int frame = 0; frame < numFrames; ++frame)
+	{
+		const float abstime = frame * dt;
+		for (size_t x = 0; x < MMRM_WIND_DIM; ++x)
+			for (size_t y = 0; y < MMRM_WIND_DIM; ++y)
+				for (size_t z = 0; z < MMRM_WIND_DIM; ++z)
+				{
+					const float gust = sin_tpl(abstime * 2.f + (float)(x + y) * 0.5f);
+					wind[x + y * MMRM_WIND_DIM + z * MMRM_WIND_DIM * MMRM_WIND_DIM] = Vec3(4.f + 3.f * gust, 2.f * gust, 0.f);
+				}
+
+		JobManager::SJobState cullState;
+		int64 start = CryGetTicks();
+		for (size_t i = 0; i < numGroups; ++i)
+		{
+			int flags = (int)MMRM_CULL_FRUSTUM | MMRM_CULL_DISTANCE;
+#if MMRM_USE_JOB_SYSTEM
+			TPVRNCullRenderMesh job(&camera, &origin, &centre, 0.f, flags);
+			job.RegisterJobState(&cullState);
+			job.SetClassInstance(&groups[i]->header);
+			job.SetPriorityLevel(JobManager::eHighPriority);
+			job.Run();
+#else
+			groups[i]->header.CullInstances(&camera, &origin, &centre, 0.f, flags);
+#endif
+		}
+		gEnv->pJobManager->WaitForJob(cullState);
+		cullTimer.ticks += CryGetTicks() - start;
+
+		JobManager::SJobState updateState;
+		start = CryGetTicks();
+		for (size_t i = 0; i < numGroups; ++i)
+		{
+			SMMRMBenchmarkGroup* group = groups[i];
+			SMMRMGroupHeader* header = &group->header;
+			SMMRMUpdateContext* update = &group->update;
+			update->group = header;
+			update->chunks.resize(header->numVisbleChunks);
+			size_t iv = 0, ii = 0;
+			for (size_t k = 0; k < header->numVisbleChunks; ++k)
+			{
+				update->chunks[k].ioff = ii;
+				update->chunks[k].voff = iv;
+				update->chunks[k].matId = header->visibleChunks[k].matId;
+				ii += (update->chunks[k].icnt = header->visibleChunks[k].indices);
+				iv += (update->chunks[k].vcnt = header->visibleChunks[k].vertices);
+			}
+			if (iv == 0 || ii == 0)
+				continue;
+			mmrm_assert(iv <= group->general.size() && ii <= group->indices.size());
+			mergedVertices += iv;
+			group->updateState = 1;
+			update->general = &group->general[0];
+			update->tangents = &group->tangents[0];
+			update->normals = &group->normals[0];
+			update->idxBuf = &group->indices[0];
+			update->updateFlag = &group->updateState;
+			update->colliders = NULL;
+			update->ncolliders = 0;
+			update->projectiles = NULL;
+			update->nprojectiles = 0;
+			update->max_iter = 1;
+			update->dt = dt;
+			update->abstime = abstime;
+			update->zRotation = 0.f;
+			update->rotationOrigin = centre;
+			update->_min = bounds.min;
+			update->_max = bounds.max;
+			update->wind = wind;
+			update->use_spines = geom->numSpines > 0u;
+			update->frame_count = frame;
+#if MMRM_USE_BOUNDS_CHECK
+			update->general_end = &group->general[0] + group->general.size();
+			update->tangents_end = &group->tangents[0] + group->tangents.size();
+			update->idx_end = &group->indices[0] + group->indices.size();
+#endif
+#if MMRM_USE_JOB_SYSTEM
+			if (header->deform_vertices)
+			{
+				TPVRNUpdateRenderMeshDeform job(&camera, 0u);
+				job.RegisterJobState(&updateState);
+				job.SetClassInstance(update);
+				job.SetPriorityLevel(JobManager::eLowPriority);
+				job.Run();
+			}
+			else
+			{
+				TPVRNUpdateRenderMeshSpines job(&camera, 0u);
+				job.RegisterJobState(&updateState);
+				job.SetClassInstance(update);
+				job.SetPriorityLevel(JobManager::eLowPriority);
+				job.Run();
+			}
+#else
+			if (header->deform_vertices)
+				update->MergeInstanceMeshesDeform(&camera, 0u);
+			else
+				update->MergeInstanceMeshesSpines(&camera, 0u);
+#endif
+		}
+		gEnv->pJobManager->WaitForJob(updateState);
+		updateTimer.ticks += CryGetTicks() - start;
+	}
+
+	const uint64 instanceFrames = (uint64)numInstances * numFrames;
+	CryLogAlways("Merged mesh benchmark: group %d '%s', %d instances in %" PRISIZE_T " batches, %d frames, seed %u",
+	             groupId, srcGroup.GetStatObj()->GetFilePath(), numInstances, numGroups, numFrames, seed);
+	CryLogAlways("  %-10s %9.3f ms/frame %10.1f ns/instance", "cull",
+	             cullTimer.Milliseconds() / numFrames, cullTimer.NsPer(instanceFrames));
+	CryLogAlways("  %-10s %9.3f ms/frame %10.1f ns/instance %8.2f ns/spine vertex %8.2f ns/deform vertex %8.2f ns/merged vertex", "update",
+	             updateTimer.Milliseconds() / numFrames, updateTimer.NsPer(instanceFrames),
+	             updateTimer.NsPer(spineVertices * numFrames), updateTimer.NsPer(deformVertices * numFrames), updateTimer.NsPer(mergedVertices));
+	CryLogAlways("  %" PRIu64 " spine vertices, %" PRIu64 " deform vertices, %.0f merged vertices per frame",
+	             spineVertices, deformVertices, (double)mergedVertices / numFrames);
+
+	for (size_t i = 0; i < numGroups; ++i)
+		delete groups[i];
+	CryModuleMemalignFree(wind);
+}
+#endif // !defined(_RELEASE)
+
 CMergedMeshesManager::CMergedMeshesManager()
 	: m_ProjectileLock()
 	, m_CurrentSizeInVramDynamic()
@@ -3776,12 +5222,10 @@ CMergedMeshesManager::CMergedMeshesManager()
 	, m_SpineSize()
 	, m_nActiveNodes()
 	, m_nStreamedOutNodes()
+	, m_nPendingStreamInNodes()
 	, m_PoolOverFlow()
 	, m_MeshListPresent()
 {
-	memset(m_CachedBBs, 0, sizeof(m_CachedBBs));
-	memset(m_CachedLRU, 0, sizeof(m_CachedLRU));
-	memset(m_CachedNodes, 0, sizeof(m_CachedNodes));
 }
 CMergedMeshesManager::~CMergedMeshesManager()
 {
@@ -3798,6 +5242,38 @@ void CMergedMeshesManager::Init()
 	{
 		m_viewDistRatioCallbackIndex = pVar->AddOnChange(UpdateRatios);
 	}
+	if (!gEnv->pConsole->GetCVar("e_MergedMeshesRenderMeshPoolSize"))
+	{
+		REGISTER_CVAR(e_MergedMeshesRenderMeshPoolSize, e_MergedMeshesRenderMeshPoolSize, VF_NULL,
+		              "Size in KB of released merged mesh rendermeshes kept for reuse. 0 = disable pooling");
+		REGISTER_CVAR(e_MergedMeshesDynamicMeshRetainFrames, e_MergedMeshesDynamicMeshRetainFrames, VF_NULL,
+		              "Number of frames the dynamic rendermesh of a merged mesh node is kept while the node is not drawn");
+		REGISTER_CVAR(e_MergedMeshesGeometryCache, e_MergedMeshesGeometryCache, VF_NULL,
+		              "Cache preprocessed merged mesh geometry in " MMRM_GEOMETRY_CACHE_FOLDER ". 0 = disabled, 1 = load and store, 2 = load only");
+		REGISTER_CVAR(e_MergedMeshesPackedSectors, e_MergedMeshesPackedSectors, VF_NULL,
+		              "Export merged mesh sectors with bit packed instance streams. 0 = legacy format, 1 = packed format");
+		REGISTER_CVAR(e_MergedMeshesParallelCompile, e_MergedMeshesParallelCompile, VF_NULL,
+		              "Compile merged mesh sectors and areas in parallel jobs. 0 = serial, 1 = parallel");
+		REGISTER_CVAR(e_MergedMeshesBroadphase, e_MergedMeshesBroadphase, VF_NULL,
+		              "Query merged mesh colliders and projectiles through a shared per frame broadphase. 0 = query per node");
+		REGISTER_CVAR(e_MergedMeshesWindGrid, e_MergedMeshesWindGrid, VF_NULL,
+		              "Sample merged mesh wind from the engine's wind grid instead of the wind areas (needs e_VegetationBending 2)");
+		REGISTER_CVAR(e_MergedMeshesStreamingLookahead, e_MergedMeshesStreamingLookahead, VF_NULL,
+		              "Seconds the camera movement is extrapolated to prefetch merged mesh sectors ahead of it. 0 = disabled");
+		REGISTER_CVAR(e_MergedMeshesStreamingFastSpeed, e_MergedMeshesStreamingFastSpeed, VF_NULL,
+		              "Camera speed in m/s at which the merged mesh streaming budget reaches e_MergedMeshesStreamRequestsMax");
+		REGISTER_CVAR(e_MergedMeshesStreamRequestsMin, e_MergedMeshesStreamRequestsMin, VF_NULL,
+		              "Merged mesh sector stream requests per frame for a static camera");
+		REGISTER_CVAR(e_MergedMeshesStreamRequestsMax, e_MergedMeshesStreamRequestsMax, VF_NULL,
+		              "Merged mesh sector stream requests per frame for a camera moving at e_MergedMeshesStreamingFastSpeed");
+
+#if !defined(_RELEASE)
+		REGISTER_COMMAND("e_MergedMeshesBenchmark", MergedMeshesBenchmarkCmd, VF_CHEAT,
+		                 "Runs culling, spine simulation and deform merging of a synthetic merged mesh sector\n"
+		                 "without renderer or physics and logs the time per instance and per spine vertex.\n"
+		                 "Usage: e_MergedMeshesBenchmark <statInstGroupId> [instances] [frames] [seed]");
+#endif
+	}
 
 	if (!s_MergedMeshPool)
 	{
@@ -3845,8 +5321,11 @@ void CMergedMeshesManager::Shutdown()
 			}
 		}
 	}
+	stl::free_container(m_NodeMap);
 	s_GeomManager.Shutdown();
+	s_RenderMeshPool.Clear();
 	stl::free_container(m_ActiveNodes);
+	stl::free_container(m_PrefetchNodes);
 	stl::free_container(m_StreamedOutNodes);
 	stl::free_container(m_VisibleNodes);
 	stl::free_container(m_Projectiles);
@@ -3886,26 +5365,122 @@ void CMergedMeshesManager::UpdateLodRatio(float value)
 			}
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Sector and area compilation
+//
+// Sectors and area clusters are independent of each other, so they are
+// compiled in batches on the job workers. Every sector and cluster writes into
+// a slot that was reserved for it up front in the same order the serial
+// compilation used, so the result does not depend on the job scheduling.
+
+struct SMMRMSectorCompileContext
+{
+	std::vector<CMergedMeshRenderNode*>  nodes;
+	std::vector<struct IStatInstGroup*>* pVegGroupTable;
+	volatile int                         failed;
+};
+
+struct SMMRMAreaCompileContext
+{
+	std::vector<std::vector<CMergedMeshRenderNode*>> clusterNodes;
+	std::vector<size_t>                              hullPoints;
+	DynArray<SMeshAreaCluster>*                      clusters;
+	int flags;
+};
+
+DECLARE_JOB(
+  "MMRM_CompileSectors"
+  , TMMRM_CompileSectors
+  , CMergedMeshesManager::CompileSectorRange);
+
+DECLARE_JOB(
+  "MMRM_CompileAreas"
+  , TMMRM_CompileAreas
+  , CMergedMeshesManager::CompileAreaRange);
+
+// Splits [0, count) into batches, runs them as jobs and waits for them in
+// order, logging the progress along the way
+template<typename TJob, typename TContext>
+static void RunCompileBatches(
+  CMergedMeshesManager* pManager
+  , void (CMergedMeshesManager::* pRange)(TContext*, uint32, uint32)
+  , TContext* pContext
+  , uint32 count
+  , const char* szWhat)
+{
+	if (count == 0)
+		return;
+	if (!e_MergedMeshesParallelCompile)
+	{
+		(pManager->*pRange)(pContext, 0, count);
+		return;
+	}
+
+	const uint32 nBatches = min(count, max(1u, (uint32)gEnv->pJobManager->GetNumWorkerThreads()) * 8u);
+	JobManager::SJobState* states = new JobManager::SJobState[nBatches];
+	for (uint32 b = 0; b < nBatches; ++b)
+	{
+		TJob job(pContext, (uint32)((uint64)count * b / nBatches), (uint32)((uint64)count * (b + 1) / nBatches));
+		job.SetClassInstance(pManager);
+		job.RegisterJobState(&states[b]);
+		job.Run();
+	}
+	for (uint32 b = 0, progress = 0; b < nBatches; ++b)
+	{
+		gEnv->pJobManager->WaitForJob(states[b]);
+		const uint32 done = (uint32)((uint64)count * (b + 1) / nBatches);
+		if (done * 10u / count > progress)
+		{
+			progress = done * 10u / count;
+			CryLogAlways("MMRM: %s %u/%u ...", szWhat, done, count);
+		}
+	}
+	delete[] states;
+}
+
+void CMergedMeshesManager::CompileSectorRange(SMMRMSectorCompileContext* pContext, uint32 begin, uint32 end)
+{
+	for (uint32 i = begin; i < end && !pContext->failed; ++i)
+	{
+		CMergedMeshRenderNode* node = pContext->nodes[i];
+		SInstanceSector& sector = m_InstanceSectors[i];
+		int nSize = 0;
+		node->Compile(NULL, nSize, NULL, NULL);
+		sector.data.resize(nSize);
+		if (node->Compile(&sector.data[0], nSize, &sector.id, pContext->pVegGroupTable) == false)
+			pContext->failed = 1;
+	}
+}
+
 bool CMergedMeshesManager::CompileSectors(std::vector<struct IStatInstGroup*>* pVegGroupTable)
 {
+	const CTimeValue startTime = gEnv->pTimer->GetAsyncTime();
+	SMMRMSectorCompileContext context;
+	context.pVegGroupTable = pVegGroupTable;
+	context.failed = 0;
+
 	m_InstanceSectors.clear();
-	int nSize = 0;
 	for (size_t i = 0; i < HashDimXY; ++i)
 		for (size_t j = 0; j < HashDimXY; ++j)
 			for (size_t k = 0; k < HashDimZ; ++k)
 			{
 				NodeListT& list = m_Nodes[i][j][k];
-				for (NodeListT::iterator it = list.begin(); it != list.end(); ++it)
-				{
-					nSize = 0;
-					SInstanceSector* pSector = m_InstanceSectors.push_back();
-					(*it)->Compile(NULL, nSize, NULL, NULL);
-					pSector->data.resize(nSize);
-
-					if ((*it)->Compile(&pSector->data[0], nSize, &pSector->id, pVegGroupTable) == false)
-						return false;
-				}
+				context.nodes.insert(context.nodes.end(), list.begin(), list.end());
 			}
+	m_InstanceSectors.resize(context.nodes.size());
+
+	CryLogAlways("MMRM: compiling %d sectors ...", (int)context.nodes.size());
+	RunCompileBatches<TMMRM_CompileSectors>(this, &CMergedMeshesManager::CompileSectorRange, &context, (uint32)context.nodes.size(), "compiled sectors");
+	if (context.failed)
+		return false;
+
+	size_t totalSize = 0;
+	for (size_t i = 0; i < m_InstanceSectors.size(); ++i)
+		totalSize += m_InstanceSectors[i].data.size();
+	CryLogAlways("MMRM: compiled %d sectors (%.1f kb) in %.2f seconds"
+	             , (int)m_InstanceSectors.size()
+	             , totalSize / 1024.f
+	             , (gEnv->pTimer->GetAsyncTime() - startTime).GetSeconds());
 	return true;
 }
 
@@ -3917,10 +5492,13 @@ void CMergedMeshesManager::ClearInstanceSectors()
 bool CMergedMeshesManager::CompileAreas(DynArray<SMeshAreaCluster>& clusters, int flags)
 {
 	const float fExtentsRec = 1.0f / c_MergedMeshesExtent;
+	const CTimeValue startTime = gEnv->pTimer->GetAsyncTime();
 
 	typedef std::unordered_map<CMergedMeshRenderNode*, size_t> ClusterMappingT;
 	ClusterMappingT mapping;
 	NodeArrayT list, stack;
+	SMMRMAreaCompileContext context;
+	const size_t firstCluster = clusters.size();
 	CryLogAlways("MMRM: clustering ...");
 
 	// Extract a list of all merged mesh nodes
@@ -3936,6 +5514,15 @@ bool CMergedMeshesManager::CompileAreas(DynArray<SMeshAreaCluster>& clusters, in
 	// No nodes means no areas - we are done
 	if (list.size() == 0)
 		return true;
+	if (!(flags & (CLUSTER_CONVEXHULL_GRAHAMSCAN | CLUSTER_CONVEXHULL_GIFTWRAP)))
+	{
+		CryFatalError(
+		  "MMRM: no clustering algorithm selected, please provide one of the following:\n"
+		  "\tCLUSTER_CONVEXHULL_GRAHAMSCAN\n"
+		  "\tCLUSTER_CONVEXHULL_GIFTWRAP\n");
+		return false;
+	}
+
 	CryLogAlways("MMRM: processing %d nodes ...", (int)list.size());
 
 	// Pick a node from the list and create a cluster. Perform a breadth-first-search on every
@@ -3949,6 +5536,7 @@ bool CMergedMeshesManager::CompileAreas(DynArray<SMeshAreaCluster>& clusters, in
 
 		size_t cluster_index = clusters.size();
 		clusters.push_back(SMeshAreaCluster());
+		context.clusterNodes.push_back(std::vector<CMergedMeshRenderNode*>());
 		clusters[cluster_index].extents.Reset();
 		stack.push_back(list[c - 1]);
 
@@ -3961,6 +5549,7 @@ bool CMergedMeshesManager::CompileAreas(DynArray<SMeshAreaCluster>& clusters, in
 			if (found != mapping.end())
 				continue;
 			mapping.insert(std::make_pair(node, cluster_index));
+			context.clusterNodes[cluster_index - firstCluster].push_back(node);
 
 			const AABB& box = node->GetInternalBBox();
 			const Vec3& centre = box.GetCenter();
@@ -3968,75 +5557,29 @@ bool CMergedMeshesManager::CompileAreas(DynArray<SMeshAreaCluster>& clusters, in
 			int _j = (int)floorf(abs(centre.y) * fExtentsRec);
 			int _k = (int)floorf(abs(centre.z) * fExtentsRec);
 
-			// Note, as this is a wrapping grid, we need to weed non-neighbours
 			for (int i = _i - 1; i <= _i + 1; ++i)
 				for (int j = _j - 1; j <= _j + 1; ++j)
 					for (int k = _k - 1; k <= _k + 1; ++k)
 					{
-						NodeListT& _list = m_Nodes[i & (HashDimXY - 1)][j & (HashDimXY - 1)][k & (HashDimZ - 1)];
-						for (NodeListT::iterator it = _list.begin(); it != _list.end(); ++it)
-						{
-							const AABB& nbox = (*it)->GetInternalBBox();
-							const Vec3& ncentre = nbox.GetCenter();
-							int ni = (int)floorf(abs(ncentre.x) * fExtentsRec);
-							int nj = (int)floorf(abs(ncentre.y) * fExtentsRec);
-							int nk = (int)floorf(abs(ncentre.z) * fExtentsRec);
-							if (abs(ni - _i) <= 1 && abs(nj - _j) <= 1 && abs(nk - _k) <= 1)
-								stack.push_back(*(it));
-						}
+						if (CMergedMeshRenderNode* neighbour = FindNode(i, j, k))
+							stack.push_back(neighbour);
 					}
 		}
 	}
 
-	// Let the clusters process all the nodes that were found by them
-	CryLogAlways("MMRM: creating %d clusters ...", (int)clusters.size());
-	for (ClusterMappingT::iterator it = mapping.begin(), end = mapping.end(); it != end; ++it)
-	{
-		CMergedMeshRenderNode* node = it->first;
-		SMeshAreaCluster& cluster = clusters[it->second];
-
-		const AABB& nodeBB = node->GetInternalBBox();
-		cluster.extents.Add(nodeBB);
-		if (flags & CLUSTER_BOUNDARY_FROM_SAMPLES)
-			node->FillSamples(cluster.boundary_points);
-		else
-		{
-			cluster.boundary_points.push_back(Vec2(nodeBB.min.x, nodeBB.min.y));
-			cluster.boundary_points.push_back(Vec2(nodeBB.max.x, nodeBB.min.y));
-			cluster.boundary_points.push_back(Vec2(nodeBB.max.x, nodeBB.max.y));
-			cluster.boundary_points.push_back(Vec2(nodeBB.min.x, nodeBB.max.y));
-		}
-	}
+	// Let the clusters process all the nodes that were found by them and
+	// calculate their boundaries
+	const uint32 nClusters = (uint32)(clusters.size() - firstCluster);
+	CryLogAlways("MMRM: creating %d clusters ...", (int)nClusters);
+	context.clusters = &clusters;
+	context.flags = flags;
+	context.hullPoints.resize(nClusters);
+	RunCompileBatches<TMMRM_CompileAreas>(this, &CMergedMeshesManager::CompileAreaRange, &context, nClusters, "created clusters");
 
-	// Now calculate the boundary for each cluster
-	CryLogAlways("MMRM: calculating boundaries ...");
-	for (size_t i = 0, end = clusters.size(); i < end; ++i)
-	{
-		if (flags & CLUSTER_CONVEXHULL_GRAHAMSCAN)
-		{
-#if !defined(EXCLUDE_NORMAL_LOG)
-			size_t boundaries = convexhull_graham_scan(clusters[i].boundary_points);
-			CryLogAlways("MMRM: cluster %d has %d points on it's convex hull", (int)i, (int)boundaries);
-#else
-			convexhull_graham_scan(clusters[i].boundary_points);
-#endif
-			continue;
-		}
-		if (flags & CLUSTER_CONVEXHULL_GIFTWRAP)
-		{
 #if !defined(EXCLUDE_NORMAL_LOG)
-			size_t boundaries = convexhull_giftwrap(clusters[i].boundary_points);
-			CryLogAlways("MMRM: cluster %d has %d points on it's convex hull", (int)i, (int)boundaries);
-#else
-			convexhull_giftwrap(clusters[i].boundary_points);
+	for (uint32 i = 0; i < nClusters; ++i)
+		CryLogAlways("MMRM: cluster %d has %d points on it's convex hull", (int)(firstCluster + i), (int)context.hullPoints[i]);
 #endif
-			continue;
-		}
-		CryFatalError(
-		  "MMRM: no clustering algorithm selected, please provide one of the following:\n"
-		  "\tCLUSTER_CONVEXHULL_GRAHAMSCAN\n"
-		  "\tCLUSTER_CONVEXHULL_GIFTWRAP\n");
-	}
 
 #if MMRM_CLUSTER_VISUALIZATION
 	if (Cry3DEngineBase::GetCVars()->e_MergedMeshesClusterVisualization > 0)
@@ -4049,48 +5592,84 @@ bool CMergedMeshesManager::CompileAreas(DynArray<SMeshAreaCluster>& clusters, in
 	}
 #endif // MMRM_CLUSTER_VISUALIZATION
 
-	CryLogAlways("MMRM: done ...");
+	CryLogAlways("MMRM: done in %.2f seconds ...", (gEnv->pTimer->GetAsyncTime() - startTime).GetSeconds());
 	return true;
 }
 
-CMergedMeshRenderNode* CMergedMeshesManager::FindNode(const Vec3& pos)
+void CMergedMeshesManager::CompileAreaRange(SMMRMAreaCompileContext* pContext, uint32 begin, uint32 end)
 {
-	for (size_t i = 0; i < 4; ++i)
-	{
-		if (m_CachedBBs[i].IsContainPoint(pos))
-			return m_CachedNodes[i];
-		else
-			++m_CachedLRU[i];
-	}
-
-	const float fExtentsRec = 1.0f / c_MergedMeshesExtent;
-	int i = (int)floorf(abs(pos.x) * fExtentsRec);
-	int j = (int)floorf(abs(pos.y) * fExtentsRec);
-	int k = (int)floorf(abs(pos.z) * fExtentsRec);
-
-	NodeListT& _list = m_Nodes[i & (HashDimXY - 1)][j & (HashDimXY - 1)][k & (HashDimZ - 1)];
-	for (NodeListT::iterator it = _list.begin(); it != _list.end(); ++it)
+	const size_t firstCluster = pContext->clusters->size() - pContext->clusterNodes.size();
+	for (uint32 c = begin; c < end; ++c)
 	{
-		CMergedMeshRenderNode* node = *it;
-		if (node->m_internalAABB.IsContainPoint(pos))
+		SMeshAreaCluster& cluster = (*pContext->clusters)[firstCluster + c];
+		const std::vector<CMergedMeshRenderNode*>& nodes = pContext->clusterNodes[c];
+		for (size_t n = 0; n < nodes.size(); ++n)
 		{
-			int oldest = -INT_MAX, oldidx = 0;
-			for (size_t i = 0; i < 4; ++i)
+			CMergedMeshRenderNode* node = nodes[n];
+			const AABB& nodeBB = node->GetInternalBBox();
+			cluster.extents.Add(nodeBB);
+			if (pContext->flags & CLUSTER_BOUNDARY_FROM_SAMPLES)
+				node->FillSamples(cluster.boundary_points);
+			else
 			{
-				if (m_CachedLRU[i] > oldest)
-				{
-					oldidx = i;
-					oldest = m_CachedLRU[i];
-				}
+				cluster.boundary_points.push_back(Vec2(nodeBB.min.x, nodeBB.min.y));
+				cluster.boundary_points.push_back(Vec2(nodeBB.max.x, nodeBB.min.y));
+				cluster.boundary_points.push_back(Vec2(nodeBB.max.x, nodeBB.max.y));
+				cluster.boundary_points.push_back(Vec2(nodeBB.min.x, nodeBB.max.y));
 			}
-			m_CachedNodes[oldidx] = node;
-			m_CachedBBs[oldidx] = node->m_internalAABB;
-			m_CachedLRU[oldidx] = 0;
-			return node;
 		}
+
+		if (pContext->flags & CLUSTER_CONVEXHULL_GRAHAMSCAN)
+			pContext->hullPoints[c] = convexhull_graham_scan(cluster.boundary_points);
+		else
+			pContext->hullPoints[c] = convexhull_giftwrap(cluster.boundary_points);
 	}
+}
 
-	return NULL;
+uint64 CMergedMeshesManager::SectorKey(int i, int j, int k)
+{
+	// 21 bits per axis cover far more sectors than any level has
+	return ((uint64)(i & 0x1fffff)) | ((uint64)(j & 0x1fffff) << 21) | ((uint64)(k & 0x1fffff) << 42);
+}
+
+uint64 CMergedMeshesManager::SectorKey(const Vec3& pos)
+{
+	const float fExtentsRec = 1.0f / c_MergedMeshesExtent;
+	return SectorKey(
+	  (int)floorf(abs(pos.x) * fExtentsRec),
+	  (int)floorf(abs(pos.y) * fExtentsRec),
+	  (int)floorf(abs(pos.z) * fExtentsRec));
+}
+
+CMergedMeshRenderNode* CMergedMeshesManager::FindNode(int i, int j, int k)
+{
+	NodeMapT::const_iterator found = m_NodeMap.find(SectorKey(i, j, k));
+	return found != m_NodeMap.end() ? found->second : NULL;
+}
+
+CMergedMeshRenderNode* CMergedMeshesManager::FindNode(const Vec3& pos)
+{
+	NodeMapT::const_iterator found = m_NodeMap.find(SectorKey(pos));
+	return found != m_NodeMap.end() ? found->second : NULL;
+}
+
+CMergedMeshRenderNode* CMergedMeshesManager::CreateNode(int i, int j, int k)
+{
+	const float fExtents = c_MergedMeshesExtent;
+	CMergedMeshRenderNode* node = new CMergedMeshRenderNode();
+	m_Nodes[i & (HashDimXY - 1)][j & (HashDimXY - 1)][k & (HashDimZ - 1)].push_back(node);
+	m_NodeMap[SectorKey(i, j, k)] = node;
+
+	Vec3 pos = Vec3(i * fExtents, j * fExtents, k * fExtents);
+	Vec3 extents = Vec3(fExtents, fExtents, fExtents);
+
+	AABB box;
+	box.max = pos + extents;
+	box.min = pos;
+	node->Setup(box, AABB(AABB::RESET), NULL);
+	node->SetActive(1);
+	m_ActiveNodes.push_back(node);
+	return node;
 }
 
 void CMergedMeshesManager::CalculateDensity()
@@ -4104,7 +5683,10 @@ void CMergedMeshesManager::CalculateDensity()
 			{
 				NodeListT& _list = m_Nodes[i][j][k];
 				for (NodeListT::iterator it = _list.begin(); it != _list.end(); ++it)
+				{
 					(*it)->CalculateDensity();
+					(*it)->ResetDensityMips();
+				}
 			}
 }
 
@@ -4112,20 +5694,53 @@ size_t CMergedMeshesManager::QueryDensity(const Vec3& pos, ISurfaceType*(&surfac
 {
 	FUNCTION_PROFILER_3DENGINE;
 
-	const float fExtentsRec = 1.0f / c_MergedMeshesExtent;
-	int i = (int)(abs(pos.x) * fExtentsRec);
-	int j = (int)(abs(pos.y) * fExtentsRec);
-	int k = (int)(abs(pos.z) * fExtentsRec);
+	CMergedMeshRenderNode* node = FindNode(pos);
+	if (node && node->m_internalAABB.IsContainPoint(pos))
+		return node->QueryDensity(pos, surfaceTypes, density);
+
+	return 0;
+}
+
+void CMergedMeshesManager::QueryDensity(SMergedMeshDensityQuery* queries, size_t count)
+{
+	FUNCTION_PROFILER_3DENGINE;
 
-	NodeListT& _list = m_Nodes[i & (HashDimXY - 1)][j & (HashDimXY - 1)][k & (HashDimZ - 1)];
-	for (NodeListT::iterator it = _list.begin(); it != _list.end(); ++it)
+	// Visit the queries sorted by sector, so every node is looked up only once
+	std::vector<std::pair<uint64, uint32>> order(count);
+	for (size_t i = 0; i < count; ++i)
+		order[i] = std::make_pair(SectorKey(queries[i].pos), (uint32)i);
+	std::sort(order.begin(), order.end());
+
+	CMergedMeshRenderNode* node = NULL;
+	for (size_t i = 0; i < count; ++i)
 	{
-		CMergedMeshRenderNode* node = *it;
-		if (node->m_internalAABB.IsContainPoint(pos))
-			return node->QueryDensity(pos, surfaceTypes, density);
+		if (i == 0 || order[i].first != order[i - 1].first)
+		{
+			NodeMapT::const_iterator found = m_NodeMap.find(order[i].first);
+			node = found != m_NodeMap.end() ? found->second : NULL;
+		}
+		SMergedMeshDensityQuery& query = queries[order[i].second];
+		query.count = 0;
+		if (node && node->m_internalAABB.IsContainPoint(query.pos) && node->QueryDensityMax(AABB(query.pos, query.pos)) > 0.f)
+			query.count = node->QueryDensity(query.pos, query.surfaceTypes, query.density);
 	}
+}
 
-	return 0;
+float CMergedMeshesManager::QueryDensityMax(const AABB& box)
+{
+	FUNCTION_PROFILER_3DENGINE;
+
+	const float fExtentsRec = 1.0f / c_MergedMeshesExtent;
+	const int imin = (int)floorf(max(box.min.x, 0.f) * fExtentsRec), imax = (int)floorf(max(box.max.x, 0.f) * fExtentsRec);
+	const int jmin = (int)floorf(max(box.min.y, 0.f) * fExtentsRec), jmax = (int)floorf(max(box.max.y, 0.f) * fExtentsRec);
+	const int kmin = (int)floorf(max(box.min.z, 0.f) * fExtentsRec), kmax = (int)floorf(max(box.max.z, 0.f) * fExtentsRec);
+	float result = 0.f;
+	for (int k = kmin; k <= kmax; ++k)
+		for (int j = jmin; j <= jmax; ++j)
+			for (int i = imin; i <= imax; ++i)
+				if (CMergedMeshRenderNode* node = FindNode(i, j, k))
+					result = max(result, node->QueryDensityMax(box));
+	return result;
 }
 
 bool CMergedMeshesManager::GetUsedMeshes(DynArray<string>& meshNames)
@@ -4180,75 +5795,19 @@ bool CMergedMeshesManager::SyncPreparationStep()
 IRenderNode* CMergedMeshesManager::AddInstance(const SProcVegSample& sample)
 {
 	MEMORY_SCOPE_CHECK_HEAP();
-	float fExtents = c_MergedMeshesExtent;
-	const float fExtentsRec = 1.0f / c_MergedMeshesExtent;
-	const Vec3& vPos = sample.pos;
-
-	int i = (int)floorf(abs(vPos.x) * fExtentsRec);
-	int j = (int)floorf(abs(vPos.y) * fExtentsRec);
-	int k = (int)floorf(abs(vPos.z) * fExtentsRec);
-
-	NodeListT& list = m_Nodes[i & (HashDimXY - 1)][j & (HashDimXY - 1)][k & (HashDimZ - 1)];
-	CMergedMeshRenderNode* node = NULL;
-	for (NodeListT::iterator it = list.begin(); it != list.end(); ++it)
-	{
-		if ((*it)->GetInternalBBox().IsContainPoint(vPos))
-		{
-			node = *it;
-			break;
-		}
-	}
-	if (!node)
-	{
-		Vec3 pos = Vec3(i * fExtents, j * fExtents, k * fExtents);
-		Vec3 extents = Vec3(fExtents, fExtents, fExtents);
-		list.push_back(node = new CMergedMeshRenderNode());
-
-		AABB box;
-		box.max = pos + extents;
-		box.min = pos;
-
-		node->Setup(box, AABB(AABB::RESET), NULL);
-		node->SetActive(1);
-		m_ActiveNodes.push_back(node);
-	}
-	return node->AddInstance(sample);
+	return GetNode(sample.pos)->AddInstance(sample);
 }
 
 CMergedMeshRenderNode* CMergedMeshesManager::GetNode(const Vec3& vPos)
 {
-	float fExtents = c_MergedMeshesExtent;
-	float fExtentsRec = 1.f / c_MergedMeshesExtent;
-
+	const float fExtentsRec = 1.0f / c_MergedMeshesExtent;
 	int i = (int)floorf(abs(vPos.x) * fExtentsRec);
 	int j = (int)floorf(abs(vPos.y) * fExtentsRec);
 	int k = (int)floorf(abs(vPos.z) * fExtentsRec);
 
-	CMergedMeshRenderNode* node = NULL;
-	NodeListT& list = m_Nodes[i & (HashDimXY - 1)][j & (HashDimXY - 1)][k & (HashDimZ - 1)];
-	for (NodeListT::iterator it = list.begin(); it != list.end(); ++it)
-	{
-		if ((*it)->GetInternalBBox().IsContainPoint(vPos))
-		{
-			node = *it;
-			break;
-		}
-	}
+	CMergedMeshRenderNode* node = FindNode(i, j, k);
 	if (!node)
-	{
-		list.push_back(node = new CMergedMeshRenderNode());
-
-		Vec3 pos = Vec3(i * fExtents, j * fExtents, k * fExtents);
-		Vec3 extents = Vec3(fExtents, fExtents, fExtents);
-
-		AABB box;
-		box.max = pos + extents;
-		box.min = pos;
-		node->Setup(box, AABB(AABB::RESET), NULL);
-		node->SetActive(1);
-		m_ActiveNodes.push_back(node);
-	}
-
+		node = CreateNode(i, j, k);
 	return node;
 }
 
@@ -4266,6 +5825,11 @@ void CMergedMeshesManager::RemoveMergedMesh(CMergedMeshRenderNode* node)
 	assert(std::find(list.begin(), list.end(), node) != list.end());
 	list.erase(std::remove(list.begin(), list.end(), node), list.end());
 
+	NodeMapT::iterator found = m_NodeMap.find(SectorKey(i, j, k));
+	assert(found != m_NodeMap.end() && found->second == node);
+	if (found != m_NodeMap.end() && found->second == node)
+		m_NodeMap.erase(found);
+
 	// Make sure it's deleted from the active list in the editor
 	m_ActiveNodes.erase(std::remove(m_ActiveNodes.begin(), m_ActiveNodes.end(), node), m_ActiveNodes.end());
 	m_StreamedOutNodes.erase(std::remove(m_StreamedOutNodes.begin(), m_StreamedOutNodes.end(), node), m_StreamedOutNodes.end());
@@ -4287,6 +5851,96 @@ void CMergedMeshesManager::SortActiveInstances(const SRenderingPassInfo& passInf
 #endif
 }
 
+void CMergedMeshesManager::UpdateCameraPrediction(const Vec3& camPos, float dt)
+{
+	const Vec3 delta = camPos - m_LastCameraPos;
+	m_LastCameraPos = camPos;
+
+	// Restart the tracking after camera cuts and teleports
+	if (!m_CameraTracked || dt <= 0.f || delta.GetLengthSquared() > sqr(c_MergedMeshesExtent * 2.f))
+	{
+		m_CameraTracked = true;
+		m_CameraVelocity.zero();
+		m_PredictedCameraPos = camPos;
+		return;
+	}
+
+	m_CameraVelocity = Lerp(m_CameraVelocity, delta / dt, min(dt * 4.f, 1.f));
+	m_PredictedCameraPos = camPos + m_CameraVelocity * max(e_MergedMeshesStreamingLookahead, 0.f);
+}
+
+CMergedMeshesManager::SStreamingCamera CMergedMeshesManager::GetStreamingCamera() const
+{
+	// UpdateStreamingPriority runs on the object streaming threads
+	AUTO_LOCK(s_StreamingCameraLock);
+	return m_StreamingCamera;
+}
+
+float CMergedMeshesManager::StreamingDistanceSq(const CMergedMeshRenderNode* node, const SStreamingCamera& camera)
+{
+	const float distanceSq = node->DistanceSq();
+	if (!camera.bPredicting)
+		return distanceSq;
+	return min(distanceSq, Distance::Point_AABBSq(camera.predictedPos, node->m_visibleAABB));
+}
+
+void CMergedMeshesManager::PrefetchPredictedSectors(const SStreamingCamera& camera, uint32& streamRequests, uint32& streamedInSize, uint32 maxStreamRequests, uint32 streamInLimit, uint32 mainMemLimit)
+{
+	CRY_PROFILE_SECTION(PROFILE_3DENGINE, "MMRMGR: predictive streaming");
+
+	const Vec3 path = camera.predictedPos - camera.pos;
+	const float length = path.GetLength();
+	if (!camera.bPredicting || length < c_MergedMeshesExtent * 0.5f)
+		return;
+
+	// Collect the sectors on and next to the predicted path in half sector steps
+	const float fExtentsRec = 1.0f / c_MergedMeshesExtent;
+	const int steps = (int)ceilf(length * fExtentsRec * 2.f);
+	uint64 lastKey = ~0ull;
+	m_PrefetchNodes.clear();
+	for (int s = 1; s <= steps; ++s)
+	{
+		const Vec3 pos = camera.pos + path * ((float)s / (float)steps);
+		const int _i = (int)floorf(abs(pos.x) * fExtentsRec);
+		const int _j = (int)floorf(abs(pos.y) * fExtentsRec);
+		const int _k = (int)floorf(abs(pos.z) * fExtentsRec);
+		if (SectorKey(_i, _j, _k) == lastKey)
+			continue;
+		lastKey = SectorKey(_i, _j, _k);
+
+		for (int i = _i - 1; i <= _i + 1; ++i)
+			for (int j = _j - 1; j <= _j + 1; ++j)
+			{
+				CMergedMeshRenderNode* node = FindNode(i, j, _k);
+				if (node && node->m_State == CMergedMeshRenderNode::PREPARED && !node->StreamedIn() && node->m_Instances)
+					stl::push_back_unique(m_PrefetchNodes, node);
+			}
+	}
+
+	// Stream them in by the same key the active nodes are kept by, so the pool
+	// does not evict a prefetched sector again in the same update
+	std::sort(m_PrefetchNodes.begin(), m_PrefetchNodes.end(), [&camera](const CMergedMeshRenderNode* a, const CMergedMeshRenderNode* b)
+	{
+		return StreamingDistanceSq(a, camera) < StreamingDistanceSq(b, camera);
+	});
+	uint32 prefetchSize = m_StreamedInSize;
+	for (size_t n = 0; n < m_PrefetchNodes.size(); ++n)
+	{
+		if (streamRequests >= maxStreamRequests || streamedInSize >= streamInLimit)
+			return;
+		CMergedMeshRenderNode* node = m_PrefetchNodes[n];
+		const uint32 currentInstSize = node->m_Instances * sizeof(SMMRMInstance);
+		if (prefetchSize + currentInstSize >= mainMemLimit)
+			continue;
+		if (node->StreamIn())
+		{
+			prefetchSize += currentInstSize;
+			streamedInSize += currentInstSize;
+			++streamRequests;
+		}
+	}
+}
+
 void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 {
 	CRY_PROFILE_SECTION(PROFILE_3DENGINE, "MergedMeshesManager: Update");
@@ -4296,7 +5950,6 @@ void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 	uint32 mainMemLimit = GetCVars()->e_MergedMeshesPool * 1024;
 	const uint32 activeSpineLimit = (mainMemLimit * GetCVars()->e_MergedMeshesPoolSpines) / 100;
 	mainMemLimit -= activeSpineLimit;
-	const uint32 streamInLimit = min(mainMemLimit >> 2, 256u << 10);
 	uint32 sumVramSizeDynamic = 0u
 	, sumVramSizeInstanced = 0u
 	, visibleInstances = 0u
@@ -4304,7 +5957,7 @@ void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 	, streamedInSize = 0u
 	, metaSize = 0u
 	, streamRequests = 0u
-	, maxStreamRequests = 16u;
+	, pendingStreamIn = 0u;
 
 #if !defined(_RELEASE)
 	const int e_MergedMeshesDebug = GetCVars()->e_MergedMeshesDebug;
@@ -4325,6 +5978,24 @@ void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 	visibleVolume.max = vMax = vPos + Vec3(fVisibleDist, fVisibleDist, fVisibleDist);
 	visibleVolume.min = vMin = vPos - Vec3(fVisibleDist, fVisibleDist, fVisibleDist);
 
+	// The streaming budget per frame grows with the camera speed, so fast
+	// cameras do not outrun the sectors coming into view
+	UpdateCameraPrediction(vPos, dt);
+	SStreamingCamera camera;
+	camera.pos = m_LastCameraPos;
+	camera.predictedPos = m_PredictedCameraPos;
+	camera.bPredicting = m_CameraTracked && !m_PredictedCameraPos.IsEquivalent(m_LastCameraPos);
+	{
+		AUTO_LOCK(s_StreamingCameraLock);
+		m_StreamingCamera = camera;
+	}
+	const float speedScale = e_MergedMeshesStreamingFastSpeed > 0.f
+	                         ? clamp_tpl(m_CameraVelocity.GetLength() / e_MergedMeshesStreamingFastSpeed, 0.f, 1.f)
+	                         : 0.f;
+	const uint32 minStreamRequests = (uint32)max(e_MergedMeshesStreamRequestsMin, 1);
+	const uint32 maxStreamRequests = minStreamRequests + (uint32)(max(e_MergedMeshesStreamRequestsMax - (int)minStreamRequests, 0) * speedScale);
+	const uint32 streamInLimit = min(mainMemLimit >> 1, (uint32)(min(mainMemLimit >> 2, 256u << 10) * (float)maxStreamRequests / (float)minStreamRequests));
+
 #if !defined(_RELEASE)
 	m_InstanceSize = 0;
 	m_SpineSize = 0;
@@ -4355,6 +6026,15 @@ void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 
 		// Maintain a sorted list of active instances - we have to wait here for the job to have completed
 		gEnv->pJobManager->WaitForJob(m_updateState);
+
+		// Nodes on the path ahead of the camera keep their place in the pool
+		if (camera.bPredicting)
+		{
+			std::stable_sort(m_ActiveNodes.begin(), m_ActiveNodes.end(), [&camera](const CMergedMeshRenderNode* a, const CMergedMeshRenderNode* b)
+			{
+				return StreamingDistanceSq(a, camera) < StreamingDistanceSq(b, camera);
+			});
+		}
 	}
 
 	// Stream in instances up until main memory pool limit
@@ -4373,7 +6053,11 @@ void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 			                                                    , "Sector(xyz)\tvisible\t\tDistanceSq\tState\t\t\tSize(kb)\t\t\tLast frame drawn");
 		}
 
-		for (size_t i = 0, activeSize = 0u; i < nActiveNodes; ++i)
+		if (!(gEnv->IsEditor() || gEnv->IsDedicated()))
+			PrefetchPredictedSectors(camera, streamRequests, streamedInSize, maxStreamRequests, streamInLimit, mainMemLimit);
+
+		size_t activeSize = 0u;
+		for (size_t i = 0; i < nActiveNodes; ++i)
 		{
 			CMergedMeshRenderNode* node = m_ActiveNodes[i];
 			metaSize += node->MetaSize();
@@ -4383,7 +6067,8 @@ void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 #if !defined(_RELEASE)
 			if (GetCVars()->e_MergedMeshesDebug & 0x2) node->PrintState(yPos);
 #endif
-			IF (node->m_LastDrawFrame != frameId, 1)
+			// Keep the dynamic mesh of briefly occluded nodes, it goes back to the rendermesh pool once the node stays hidden
+			IF ((frameId - node->m_LastDrawFrame) > (uint32)max(e_MergedMeshesDynamicMeshRetainFrames, 0), 1)
 			{
 				node->m_SizeInVRam = 0u;
 				node->DeleteRenderMesh(CMergedMeshRenderNode::RUT_DYNAMIC);
@@ -4436,6 +6121,8 @@ void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 						++streamRequests;
 					}
 				}
+				if (!(gEnv->IsEditor() || gEnv->IsDedicated()) && !node->StreamedIn())
+					++pendingStreamIn;
 				activeSize += currentInstSize;
 #if !defined(_RELEASE)
 				m_InstanceSize += currentInstSize;
@@ -4448,6 +6135,8 @@ void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 					node->StreamOut();
 			}
 		}
+		m_StreamedInSize = (uint32)activeSize;
+
 		for (size_t i = 0, activeSize = 0u; i < nVisibleNodes; ++i)
 		{
 			CMergedMeshRenderNode* node = m_VisibleNodes[i];
@@ -4546,6 +6235,8 @@ void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 	}
 #endif // MMRM_CLUSTER_VISUALIZATION
 
+	s_RenderMeshPool.Trim();
+
 	m_CurrentSizeInVramDynamic = sumVramSizeDynamic;
 	m_CurrentSizeInVramInstanced = sumVramSizeInstanced;
 	m_CurrentSizeInMainMem = metaSize;
@@ -4553,6 +6244,7 @@ void CMergedMeshesManager::Update(const SRenderingPassInfo& passInfo)
 	m_VisibleInstances = visibleInstances;
 	m_nActiveNodes = (uint32)m_ActiveNodes.size();
 	m_nStreamedOutNodes = (uint32)m_StreamedOutNodes.size();
+	m_nPendingStreamInNodes = pendingStreamIn;
 	m_InstanceCount = nActiveInstances;
 }
 
@@ -4609,10 +6301,25 @@ void CMergedMeshesManager::PostRenderMeshes(const SRenderingPassInfo& passInfo)
 	size_t num_nodes = m_PostRenderNodes.size();
 	for (size_t i = 0; i < num_nodes; ++i)
 		m_PostRenderNodes[i].first->SampleWind();
+
+	// Gather the colliders and projectiles of all nodes at once
+	{
+		CRY_PROFILE_SECTION(PROFILE_3DENGINE, "MMRMGR: broadphase");
+		AABB bounds(AABB::RESET);
+		for (size_t i = 0; i < num_nodes; ++i)
+			bounds.Add(m_PostRenderNodes[i].first->m_visibleAABB);
+		s_Broadphase.Begin(bounds);
+		{
+			ReadLock lock(m_ProjectileLock);
+			s_Broadphase.AddProjectiles(m_Projectiles);
+		}
+		s_Broadphase.Finish();
+	}
 	for (size_t i = 0; i < num_nodes; ++i)
 		m_PostRenderNodes[i].first->QueryColliders();
 	for (size_t i = 0; i < num_nodes; ++i)
 		m_PostRenderNodes[i].first->QueryProjectiles();
+	s_Broadphase.End();
 
 	// Perform the post render
 	do
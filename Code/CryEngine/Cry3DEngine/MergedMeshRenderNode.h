@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 // Global define to enable and disable some debugging features (defined &
 // described below) to help finding issues in merged meshes at runtime.
 #define MMRM_DEBUG 1
@@ -103,6 +105,10 @@
 // The compile-time default poolsize in bytes
 #define MMRM_DEFAULT_POOLSIZE_STR "2750"
 
+// Number of frames a released rendermesh stays in the pool before it can be
+// refilled, covering the frames the renderer might still have in flight
+#define MMRM_RENDERMESH_POOL_LATENCY (3u)
+
 // Increase the damping for this amount of time when undergoing severe contacts
 #define MMRM_PLASTICITY_TIME (10000)
 
@@ -142,12 +148,15 @@
 struct SMMRMGroupHeader;
 struct SMMRM;
 struct SSampleDensity;
+struct SMMRMDensityMips;
 struct SProcVegSample;
 struct SMMRMProfilingInfo;
 struct SMergedMeshPriorityCmp;
 struct SMMRMProjectile;
 struct SMergedMeshSectorChunk;
 struct SMergedMeshInstanceCompressed;
+struct SMMRMSectorCompileContext;
+struct SMMRMAreaCompileContext;
 
 ////////////////////////////////////////////////////////////////////////////////
 // RenderNode for merged meshes
@@ -174,13 +183,17 @@ struct SMergedMeshInstanceCompressed;
 // simulation state should touch bending be enabled on an instance type), the
 // actual storage can be streamed out and in on demand on runtime.
 //
-// ToDo items:
+// The rendermeshes are taken from a pool bucketed by vertex and index
+// capacity and handed back to it when a node releases them, so rebuilding the
+// merged meshes does not reallocate vram every frame.
 //
-//  - The rendermesh is re-created every frame and not pooled currently, so
-// vram can (and will) run out of bounds if care is not taken to reduce the
-// load. This will be addressed in a near-future commit.
+// The cgf is preprocessed at runtime the first time it is used, the result is
+// cached in the user folder and reused by later runs as long as the source cgf
+// and the preprocessing options do not change (see e_MergedMeshesGeometryCache).
 //
-//  - The cgf is preprocessed at runtime, this can be moved to level export time
+// ToDo items:
+//
+//  - The preprocessing cache could be generated at level export time
 //
 class CMergedMeshRenderNode final
 	: public IRenderNode
@@ -307,6 +320,10 @@ class CMergedMeshRenderNode final
 	// The density samples
 	SSampleDensity* m_density;
 
+	// Conservative maximum density pyramid over the density samples, built on
+	// the first query after the samples changed
+	SMMRMDensityMips* m_densityMips;
+
 	// The list of colliders, approximated as spheres. Probably more elaborate
 	// primitives will be supported in the future
 	primitives::sphere* m_Colliders;
@@ -372,6 +389,19 @@ class CMergedMeshRenderNode final
 	// Query the sample density grid. Returns the number of surface types filled into the surface types list
 	size_t QueryDensity(const Vec3& pos, IMergedMeshesManager::TFixedSurfacePtrTypeArray& surfaceTypes, IMergedMeshesManager::TFixedDensityArray& density);
 
+	// Returns the density pyramid of the node, builds it if the samples changed.
+	// The caller has to hold the density pyramid lock
+	const SMMRMDensityMips* DensityMips();
+
+	// Upper bound of the summed density of all surface types inside the box
+	float QueryDensityMax(const AABB& box);
+
+	// Frees the density pyramid, has to be called whenever the samples change
+	void ResetDensityMips();
+
+	// Frees the density samples together with their pyramid
+	void FreeDensity();
+
 	// Resets the node to the initial dirty state
 	void Reset();
 
@@ -593,6 +623,15 @@ struct SProjectile
 	bool operator<(const SProjectile& other) const { return entity < other.entity; }
 };
 
+// A single query of the batched CMergedMeshesManager::QueryDensity
+struct SMergedMeshDensityQuery
+{
+	Vec3 pos;
+	IMergedMeshesManager::TFixedSurfacePtrTypeArray surfaceTypes;
+	IMergedMeshesManager::TFixedDensityArray        density;
+	size_t count;
+};
+
 class CMergedMeshesManager
 	: public Cry3DEngineBase
 	  , public IMergedMeshesManager
@@ -608,11 +647,13 @@ class CMergedMeshesManager
 	typedef std::vector<std::pair<CMergedMeshRenderNode*, const SRenderingPassInfo&>> PostNodeArrayT;
 	typedef std::vector<SProjectile>            ProjectileArrayT;
 	typedef DynArray<SInstanceSector>           InstanceSectors;
+	typedef std::unordered_map<uint64, CMergedMeshRenderNode*> NodeMapT;
 
 	// For tracking fast moving projectiles
 	static int OnPhysPostStep(const EventPhys*);
 
 	NodeArrayT       m_Nodes[HashDimXY][HashDimXY][HashDimZ];
+	NodeMapT         m_NodeMap; // all nodes keyed by their sector coordinates
 	NodeArrayT       m_ActiveNodes;
 	NodeArrayT       m_StreamedOutNodes;
 	NodeArrayT       m_VisibleNodes;
@@ -634,13 +675,10 @@ class CMergedMeshesManager
 	size_t                 m_SpineSize;
 	size_t                 m_nActiveNodes;
 	size_t                 m_nStreamedOutNodes;
+	size_t                 m_nPendingStreamInNodes; // Active nodes within the pool limit not streamed in yet
 	bool                   m_PoolOverFlow;
 	bool                   m_MeshListPresent;
 
-	AABB                   m_CachedBBs[4];
-	int                    m_CachedLRU[4];
-	CMergedMeshRenderNode* m_CachedNodes[4];
-
 #if MMRM_CLUSTER_VISUALIZATION
 	DynArray<SMeshAreaCluster> m_clusters;
 #endif // MMRM_CLUSTER_VISUALIZATION
@@ -648,7 +686,42 @@ class CMergedMeshesManager
 	uint64 m_lodRatioCallbackIndex = -1;
 	uint64 m_viewDistRatioCallbackIndex = -1;
 
+	// Smoothed camera velocity and the position the camera is predicted to
+	// reach, used to stream in sectors ahead of fast moving cameras
+	Vec3   m_CameraVelocity = Vec3(ZERO);
+	Vec3   m_LastCameraPos = Vec3(ZERO);
+	Vec3   m_PredictedCameraPos = Vec3(ZERO);
+	bool   m_CameraTracked = false;
+
+	// Camera prediction as seen by the streaming, published once per frame by Update
+	struct SStreamingCamera
+	{
+		Vec3 pos = Vec3(ZERO);
+		Vec3 predictedPos = Vec3(ZERO);
+		bool bPredicting = false;
+	};
+	SStreamingCamera m_StreamingCamera;
+
+	// Scratch list of the sectors along the predicted path
+	NodeArrayT m_PrefetchNodes;
+
+	// Instance memory of the streamed in nodes after the last update
+	uint32 m_StreamedInSize = 0;
+
+	void UpdateCameraPrediction(const Vec3& camPos, float dt);
+	void PrefetchPredictedSectors(const SStreamingCamera& camera, uint32& streamRequests, uint32& streamedInSize, uint32 maxStreamRequests, uint32 streamInLimit, uint32 mainMemLimit);
+
+	// Streaming priority of a node, the closer of its current and predicted camera distance
+	static float StreamingDistanceSq(const CMergedMeshRenderNode* node, const SStreamingCamera& camera);
+	SStreamingCamera GetStreamingCamera() const;
+
+	// Packs the sector coordinates of a position into the key of the node map
+	static uint64          SectorKey(int i, int j, int k);
+	static uint64          SectorKey(const Vec3& pos);
+
 	CMergedMeshRenderNode* FindNode(const Vec3& pos);
+	CMergedMeshRenderNode* FindNode(int i, int j, int k);
+	CMergedMeshRenderNode* CreateNode(int i, int j, int k);
 
 	void                   AddProjectile(const SProjectile&);
 
@@ -672,9 +745,22 @@ public:
 	// Compile cluster areas
 	bool CompileAreas(DynArray<SMeshAreaCluster>& clusters, int flags);
 
+	// Job entry points of the sector and area compilation, compile the sectors
+	// or clusters in [begin, end) of the context
+	void CompileSectorRange(SMMRMSectorCompileContext* pContext, uint32 begin, uint32 end);
+	void CompileAreaRange(SMMRMAreaCompileContext* pContext, uint32 begin, uint32 end);
+
 	//	Query the sample density grid. Returns the number of surface types filled into the surface types list
 	size_t QueryDensity(const Vec3& pos, IMergedMeshesManager::TFixedSurfacePtrTypeArray& surfaceTypes, IMergedMeshesManager::TFixedDensityArray& density);
 
+	// Batched version of the above, queries in the same sector share the node
+	// lookup. Fills in the surface types, densities and count of every query
+	void QueryDensity(SMergedMeshDensityQuery* queries, size_t count);
+
+	// Upper bound of the summed density of all surface types inside the box,
+	// answered from the density pyramids of the overlapping nodes
+	float QueryDensityMax(const AABB& box);
+
 	// Fill in the density values
 	void                   CalculateDensity();
 
@@ -708,5 +794,6 @@ public:
 	size_t SpineSize() const                  { return m_SpineSize; }
 	size_t ActiveNodes() const                { return m_nActiveNodes; }
 	size_t StreamedOutNodes() const           { return m_nStreamedOutNodes; }
+	size_t PendingStreamInNodes() const       { return m_nPendingStreamInNodes; }
 	bool   PoolOverFlow() const               { return m_PoolOverFlow; }
 };
@@ -258,6 +258,7 @@ void ReadCTimeOfDayVariableFromXmlNode(CTimeOfDayVariable* pVar, XmlNodeRef varN
 
 		ISplineInterpolator::ValueType fValue;
 		const int nKeyCount = floatSpline.GetKeyCount();
+		pSpline->BeginEdit();
 		pSpline->Resize(nKeyCount);
 		for (int k = 0; k < nKeyCount; ++k)
 		{
@@ -282,6 +283,7 @@ void ReadCTimeOfDayVariableFromXmlNode(CTimeOfDayVariable* pVar, XmlNodeRef varN
 			key.m_controlPoint.m_outTangentType = ESplineKeyTangentTypeToETangentType(outTangentType);
 			key.m_controlPoint.m_outTangent = Vec2(fTangentsOut[0], fTangentsOut[1]);
 		}   //for k
+		pSpline->EndEdit();
 	}
 	else if (var.GetType() == ITimeOfDay::TYPE_COLOR)
 	{
@@ -292,9 +294,11 @@ void ReadCTimeOfDayVariableFromXmlNode(CTimeOfDayVariable* pVar, XmlNodeRef varN
 		ISplineInterpolator::ValueType fValue;
 		const int nKeyCount = colorSpline.GetKeyCount();
 
-		var.GetSpline(0)->Resize(nKeyCount);
-		var.GetSpline(1)->Resize(nKeyCount);
-		var.GetSpline(2)->Resize(nKeyCount);
+		for (int i = 0; i < 3; ++i)
+		{
+			var.GetSpline(i)->BeginEdit();
+			var.GetSpline(i)->Resize(nKeyCount);
+		}
 		for (int k = 0; k < nKeyCount; ++k)
 		{
 			float fKeyTime = colorSpline.GetKeyTime(k) * CEnvironmentPreset::GetAnimTimeSecondsIn24h();
@@ -324,6 +328,11 @@ void ReadCTimeOfDayVariableFromXmlNode(CTimeOfDayVariable* pVar, XmlNodeRef varN
 			key.m_controlPoint.m_value = fValue[2];
 			var.GetSpline(2)->GetKey(k) = key;
 		}
+
+		for (int i = 0; i < 3; ++i)
+		{
+			var.GetSpline(i)->EndEdit();
+		}
 	}
 }
 
@@ -355,7 +364,9 @@ void MigrateLegacyData(CEnvironmentPreset& preset, bool bSunIntensity)
 		CTimeOfDayVariable* varHDRPower = preset.GetVar(ITimeOfDay::PARAM_HDR_DYNAMIC_POWER_FACTOR);
 
 		CBezierSpline* varSunMultSpline = varSunMult->GetSpline(0);
+		CBezierSpline* varSunIntensitySpline = varSunIntensity->GetSpline(0);
 		const int numKeys = varSunMultSpline->GetKeyCount();
+		varSunIntensitySpline->BeginEdit();
 		for (int key = 0; key < numKeys; ++key)
 		{
 			SBezierKey& varSunMultKey = varSunMultSpline->GetKey(key);
@@ -373,8 +384,9 @@ void MigrateLegacyData(CEnvironmentPreset& preset, bool bSunIntensity)
 			float sunColorLum = sunColorR * 0.2126f + sunColorG * 0.7152f + sunColorB * 0.0722f;
 			float sunIntensity = sunMult * sunColorLum * hdrMult * 10000.0f * gf_PI;
 
-			varSunIntensity->GetSpline(0)->InsertKey(anim_time, sunIntensity);
+			varSunIntensitySpline->InsertKey(anim_time, sunIntensity);
 		}
+		varSunIntensitySpline->EndEdit();
 	}
 }
 
@@ -473,6 +485,245 @@ Vec3 ConvertIlluminanceToLightColor(float illuminance, Vec3 colorRGB)
 	return finalColor;
 }
 
+// Decoupled update (e_TimeOfDayUpdateRate / e_TimeOfDayUpdateMinDelta): the splines are evaluated at a reduced rate
+// and the values pushed every frame are interpolated between the two most recent evaluations
+float e_TimeOfDayUpdateRate = 0.0f;
+float e_TimeOfDayUpdateMinDelta = 0.0f;
+
+struct SDecoupledUpdateState
+{
+	Vec3  prevValues[ITimeOfDay::PARAM_TOTAL];
+	Vec3  nextValues[ITimeOfDay::PARAM_TOTAL];
+	float prevTime = 0.0f; // hours
+	float nextTime = 0.0f; // hours, not wrapped to [0, 24)
+	bool  bValid = false;
+};
+
+SDecoupledUpdateState s_decoupledUpdate;
+
+// Preset whose constants were last pushed by ConstantsChanged, switching presets requires a full update
+const CEnvironmentPreset* s_pConstantsAppliedPreset = nullptr;
+
+// Signed shortest distance between two times of the 24h clock
+float GetWrappedHourDelta(float fFrom, float fTo)
+{
+	float fDelta = fTo - fFrom;
+	if (fDelta > 12.0f)
+		fDelta -= 24.0f;
+	else if (fDelta < -12.0f)
+		fDelta += 24.0f;
+	return fDelta;
+}
+
+void EvaluatePresetAt(CEnvironmentPreset& preset, float fHour, Vec3* pValues)
+{
+	fHour = fmod_tpl(fHour, 24.0f);
+	if (fHour < 0.0f)
+		fHour += 24.0f;
+
+	const float fSplineTime = fHour / 24.0f * CEnvironmentPreset::GetAnimTimeSecondsIn24h();
+	for (int i = 0; i < ITimeOfDay::PARAM_TOTAL; ++i)
+	{
+		pValues[i] = preset.GetVar(static_cast<ITimeOfDay::ETimeOfDayParamID>(i))->GetInterpolatedAt(fSplineTime);
+	}
+}
+
+#if !defined(_RELEASE)
+//////////////////////////////////////////////////////////////////////////
+// e_TimeOfDayBenchmark: headless micro-benchmark of the time of day evaluation paths.
+// Reports ns per call and the number of heap allocations performed by the module while measuring.
+struct SBenchmarkSample
+{
+	int64 nStartTicks;
+	int   nStartAllocations;
+
+	SBenchmarkSample()
+	{
+		nStartAllocations = GetAllocationCount();
+		nStartTicks = CryGetTicks();
+	}
+
+	static int GetAllocationCount()
+	{
+		CryModuleMemoryInfo memInfo;
+		memset(&memInfo, 0, sizeof(memInfo));
+		CryGetMemoryInfoForModule(&memInfo);
+		return memInfo.num_allocations;
+	}
+
+	void Report(const char* szName, const char* szContext, uint64 nCalls) const
+	{
+		const int64 nTicks = CryGetTicks() - nStartTicks;
+		const int nAllocations = GetAllocationCount() - nStartAllocations;
+		const double fNsPerCall = nCalls ? (double(nTicks) * 1e9 / double(CryGetTicksPerSec())) / double(nCalls) : 0.0;
+		CryLogAlways("  %-32s %-24s %10.1f ns/call  %8" PRIu64 " calls  %6d allocs", szName, szContext, fNsPerCall, nCalls, nAllocations);
+	}
+};
+
+// Prevents the compiler from discarding the benchmarked evaluations
+volatile float s_fBenchmarkSink = 0.0f;
+
+void BenchmarkPreset(CEnvironmentPreset& preset, const char* szContext, int nIterations)
+{
+	// Times are swept over the full day so every spline segment is visited
+	const int nTimeSteps = 97;
+	const float fSecondsIn24h = CEnvironmentPreset::GetAnimTimeSecondsIn24h();
+
+	{
+		const SBenchmarkSample sample;
+		for (int i = 0; i < nIterations; ++i)
+		{
+			preset.Update(float(i % nTimeSteps) / float(nTimeSteps - 1));
+		}
+		sample.Report("CTimeOfDayVariables::Update", szContext, uint64(nIterations));
+	}
+
+	{
+		float fSum = 0.0f;
+		const SBenchmarkSample sample;
+		for (int i = 0; i < nIterations; ++i)
+		{
+			const float fTime = float(i % nTimeSteps) / float(nTimeSteps - 1) * fSecondsIn24h;
+			fSum += preset.GetVar(ITimeOfDay::PARAM_SUN_COLOR)->GetInterpolatedAt(fTime).x;
+		}
+		sample.Report("CTimeOfDayVariable (3 splines)", szContext, uint64(nIterations));
+		s_fBenchmarkSink = fSum;
+	}
+
+	{
+		const unsigned int nCount = 256;
+		std::vector<Vec3> results(nCount);
+		ITimeOfDay::IVariables& variables = preset.GetVariables();
+		const int nCalls = max(nIterations / 16, 1);
+
+		const SBenchmarkSample sample;
+		for (int i = 0; i < nCalls; ++i)
+		{
+			variables.InterpolateVarInRange(ITimeOfDay::PARAM_FOG_COLOR, 0.0f, fSecondsIn24h, nCount, results.data());
+		}
+		sample.Report("InterpolateVarInRange (x256)", szContext, uint64(nCalls));
+	}
+}
+
+void BenchmarkSpline(int nKeys, int nIterations)
+{
+	CBezierSpline spline;
+	const float fSecondsIn24h = CEnvironmentPreset::GetAnimTimeSecondsIn24h();
+
+	spline.BeginEdit();
+	for (int i = 0; i < nKeys; ++i)
+	{
+		spline.InsertKey(SAnimTime(fSecondsIn24h * float(i) / float(nKeys - 1)), float(i & 1));
+	}
+	spline.EndEdit();
+
+	stack_string context;
+	context.Format("%d keys", nKeys);
+
+	float fSum = 0.0f;
+	const SBenchmarkSample sample;
+	for (int i = 0; i < nIterations; ++i)
+	{
+		fSum += spline.Evaluate(float(i % 997) / 996.0f * fSecondsIn24h);
+	}
+	sample.Report("CBezierSpline::Evaluate", context.c_str(), uint64(nIterations));
+	s_fBenchmarkSink = fSum;
+}
+
+// Same comparison the constants use to find the categories ConstantsChanged() has to re-apply
+template<typename T>
+bool BenchmarkCategoryChanged(T& category, DynArray<char>& before, DynArray<char>& after)
+{
+	Serialization::SaveBinaryBuffer(before, category);
+	Serialization::SaveBinaryBuffer(after, category);
+	return before.size() != after.size() || memcmp(before.data(), after.data(), before.size()) != 0;
+}
+
+void BenchmarkConstantsChanged(int nIterations)
+{
+	// The constants of a private preset are used and nothing is pushed to the engine or the
+	// renderer, so only the change propagation is timed and the active time of day is untouched
+	std::unique_ptr<CEnvironmentPreset> pPreset(new CEnvironmentPreset);
+	STimeOfDayConstants& constants = static_cast<STimeOfDayConstants&>(pPreset->GetConstants());
+	const int nCalls = max(nIterations / 100, 1);
+
+	{
+		DynArray<char> before, after;
+		const SBenchmarkSample sample;
+		for (int i = 0; i < nCalls; ++i)
+		{
+			uint32 categories = 0;
+			categories |= BenchmarkCategoryChanged(constants.sun, before, after) ? ITimeOfDay::CONSTANTS_SUN : 0;
+			categories |= BenchmarkCategoryChanged(constants.moon, before, after) ? ITimeOfDay::CONSTANTS_MOON : 0;
+			categories |= BenchmarkCategoryChanged(constants.sky, before, after) ? ITimeOfDay::CONSTANTS_SKY : 0;
+			categories |= BenchmarkCategoryChanged(constants.wind, before, after) ? ITimeOfDay::CONSTANTS_WIND : 0;
+			categories |= BenchmarkCategoryChanged(constants.cloudShadows, before, after) ? ITimeOfDay::CONSTANTS_CLOUD_SHADOWS : 0;
+			categories |= BenchmarkCategoryChanged(constants.colorGrading, before, after) ? ITimeOfDay::CONSTANTS_COLOR_GRADING : 0;
+			categories |= BenchmarkCategoryChanged(constants.totalIllumination, before, after) ? ITimeOfDay::CONSTANTS_TOTAL_ILLUMINATION : 0;
+			categories |= BenchmarkCategoryChanged(constants.totalIlluminationAdvanced, before, after) ? ITimeOfDay::CONSTANTS_TOTAL_ILLUMINATION : 0;
+			constants.MarkChanged(categories);
+		}
+		sample.Report("ITimeOfDay::IConstants change detection", "all categories", uint64(nCalls));
+	}
+
+	{
+		uint32 nApplied = 0;
+		const SBenchmarkSample sample;
+		for (int i = 0; i < nCalls; ++i)
+		{
+			constants.MarkChanged(ITimeOfDay::CONSTANTS_WIND | ITimeOfDay::CONSTANTS_SUN);
+			nApplied += constants.ConsumeChangedCategories(ITimeOfDay::CONSTANTS_WIND);
+			nApplied += constants.ConsumeChangedCategories();
+		}
+		sample.Report("ITimeOfDay::IConstants changed categories", "wind, then the rest", uint64(nCalls));
+		s_fBenchmarkSink = float(nApplied);
+	}
+}
+
+// Usage: e_TimeOfDayBenchmark [iterations] [preset.xml ...]
+void TimeOfDayBenchmarkCmd(IConsoleCmdArgs* pArgs)
+{
+	int nIterations = 100000;
+	if (pArgs->GetArgCount() > 1)
+	{
+		nIterations = max(atoi(pArgs->GetArg(1)), 1);
+	}
+
+	CryLogAlways("Time of day benchmark: %d iterations", nIterations);
+
+	static const int s_splineKeyCounts[] = { 2, 8, 32, 128 };
+	for (int nKeys : s_splineKeyCounts)
+	{
+		BenchmarkSpline(nKeys, nIterations);
+	}
+
+	if (pArgs->GetArgCount() > 2)
+	{
+		// Presets are loaded into private instances, so the active time of day state is left untouched
+		for (int i = 2; i < pArgs->GetArgCount(); ++i)
+		{
+			const char* szFilename = pArgs->GetArg(i);
+			if (!gEnv->pCryPak->IsFileExist(szFilename))
+			{
+				CryLogAlways("  Preset not found: %s", szFilename);
+				continue;
+			}
+
+			std::unique_ptr<CEnvironmentPreset> pPreset(new CEnvironmentPreset);
+			Serialization::LoadXmlFile(*pPreset, szFilename);
+			BenchmarkPreset(*pPreset, PathUtil::GetFileName(szFilename).c_str(), nIterations);
+		}
+	}
+	else
+	{
+		std::unique_ptr<CEnvironmentPreset> pPreset(new CEnvironmentPreset);
+		BenchmarkPreset(*pPreset, "default preset", nIterations);
+	}
+
+	BenchmarkConstantsChanged(nIterations);
+}
+#endif // !defined(_RELEASE)
+
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -491,6 +742,22 @@ CTimeOfDay::CTimeOfDay()
 	m_advancedInfo.fStartTime = 0;
 	m_advancedInfo.fEndTime = 24;
 	m_pTimeOfDaySpeedCVar = gEnv->pConsole->GetCVar("e_TimeOfDaySpeed");
+
+	if (!gEnv->pConsole->GetCVar("e_TimeOfDayUpdateRate"))
+	{
+		REGISTER_CVAR(e_TimeOfDayUpdateRate, 0.0f, VF_NULL,
+		              "Rate (Hz) at which an animating time of day fully evaluates the environment.\n"
+		              "Values pushed in between are interpolated from the two most recent evaluations. 0 = every frame");
+		REGISTER_CVAR(e_TimeOfDayUpdateMinDelta, 0.0f, VF_NULL,
+		              "Minimum change of game time (hours) between two full time of day evaluations when animating. 0 = disabled");
+
+#if !defined(_RELEASE)
+		REGISTER_COMMAND("e_TimeOfDayBenchmark", TimeOfDayBenchmarkCmd, VF_CHEAT,
+		                 "Measures the time of day evaluation paths (spline evaluation, variable update, range interpolation,\n"
+		                 "constants propagation) and logs ns per call and allocation counts.\n"
+		                 "Usage: e_TimeOfDayBenchmark [iterations] [preset.xml ...]");
+#endif
+	}
 }
 
 bool CTimeOfDay::GetPresetsInfos(SPresetInfo* resultArray, unsigned int arraySize) const
@@ -975,31 +1242,73 @@ void CTimeOfDay::Update(bool bInterpolate, bool bForceUpdate)
 		m_pCurrentPreset->Update(normalizedTime);
 	}
 
+	// values were set explicitly, restart decoupled interpolation from them
+	s_decoupledUpdate.bValid = false;
+
 	// update environment lighting according to new interpolated values
 	UpdateEnvLighting(bForceUpdate);
 }
 
 void CTimeOfDay::ConstantsChanged()
+{
+	// Changes made through IConstants::Serialize are tracked per category, anything else may have touched every constant
+	STimeOfDayConstants& constants = static_cast<STimeOfDayConstants&>(GetPreset().GetConstants());
+	const uint32 categories = constants.ConsumeChangedCategories();
+
+	ConstantsChanged(categories ? categories : CONSTANTS_ALL);
+}
+
+void CTimeOfDay::ConstantsChanged(uint32 categories)
 {
 	C3DEngine* p3DEngine((C3DEngine*)gEnv->p3DEngine);
 
-	p3DEngine->UpdateMoonParams();
-	p3DEngine->UpdateWindParams();
-	p3DEngine->UpdateCloudShadows();
-	
-	// Empty texture means disable color grading; Transition time == 0 -> switch immediately
-	const auto& cgp = GetConstants().GetColorGradingParams();
-	p3DEngine->GetColorGradingCtrl()->SetColorGradingLut(cgp.useTexture ? cgp.texture.c_str() : "", 0.f);
+	// A different preset brings its own set of constants
+	CEnvironmentPreset* pPreset = &GetPreset();
+	if (pPreset != s_pConstantsAppliedPreset)
+	{
+		s_pConstantsAppliedPreset = pPreset;
+		categories = CONSTANTS_ALL;
+	}
+	// Only the applied categories are done, others stay pending for the next ConstantsChanged()
+	static_cast<STimeOfDayConstants&>(pPreset->GetConstants()).ConsumeChangedCategories(categories);
+
+	if (categories & CONSTANTS_MOON)
+		p3DEngine->UpdateMoonParams();
+
+	if (categories & CONSTANTS_WIND)
+		p3DEngine->UpdateWindParams();
+
+	if (categories & CONSTANTS_CLOUD_SHADOWS)
+		p3DEngine->UpdateCloudShadows();
+
+	if (categories & CONSTANTS_COLOR_GRADING)
+	{
+		// Empty texture means disable color grading; Transition time == 0 -> switch immediately
+		const auto& cgp = GetConstants().GetColorGradingParams();
+		p3DEngine->GetColorGradingCtrl()->SetColorGradingLut(cgp.useTexture ? cgp.texture.c_str() : "", 0.f);
+	}
 
 #if defined(FEATURE_SVO_GI)
-	p3DEngine->UpdateTISettings();
+	if (categories & CONSTANTS_TOTAL_ILLUMINATION)
+		p3DEngine->UpdateTISettings();
 #endif
 
-	//Will update sun params, and recalculate dependent on it lighting
-	UpdateEnvLighting(true);
+	//Will update sun params, sky materials and recalculate dependent on it lighting
+	if (categories & (CONSTANTS_SUN | CONSTANTS_SKY))
+		UpdateEnvLighting(true);
 }
 
 //////////////////////////////////////////////////////////////////////////
+// Post effect parameters driven by the time of day, resolved once instead of hashing names every update
+static SPostEffectParamHandle s_sunShaftsActiveParam("SunShafts_Active");
+static SPostEffectParamHandle s_sunShaftsAmountParam("SunShafts_Amount");
+static SPostEffectParamHandle s_sunShaftsRaysAmountParam("SunShafts_RaysAmount");
+static SPostEffectParamHandle s_sunShaftsRaysAttenuationParam("SunShafts_RaysAttenuation");
+static SPostEffectParamHandle s_sunShaftsRaysSunColInfluenceParam("SunShafts_RaysSunColInfluence");
+static SPostEffectParamHandle s_sunShaftsRaysCustomColorParam("SunShafts_RaysCustomColor");
+static SPostEffectParamHandle s_dofFocusRangeParam("Dof_Tod_FocusRange");
+static SPostEffectParamHandle s_dofBlurAmountParam("Dof_Tod_BlurAmount");
+
 void CTimeOfDay::UpdateEnvLighting(bool forceUpdate)
 {
 	C3DEngine* p3DEngine((C3DEngine*)gEnv->p3DEngine);
@@ -1278,12 +1587,12 @@ void CTimeOfDay::UpdateEnvLighting(bool forceUpdate)
 
 	const Vec4 pSunRaysCustomColor = Vec4(GetValue(PARAM_SUN_RAYS_CUSTOMCOLOR), 1.0f);
 
-	p3DEngine->SetPostEffectParam("SunShafts_Active", (fSunShaftsVis > 0.05f || fSunRaysVis > 0.05f) ? 1.f : 0.f);
-	p3DEngine->SetPostEffectParam("SunShafts_Amount", fSunShaftsVis);
-	p3DEngine->SetPostEffectParam("SunShafts_RaysAmount", fSunRaysVis);
-	p3DEngine->SetPostEffectParam("SunShafts_RaysAttenuation", fSunRaysAtten);
-	p3DEngine->SetPostEffectParam("SunShafts_RaysSunColInfluence", fSunRaySunColInfluence);
-	p3DEngine->SetPostEffectParamVec4("SunShafts_RaysCustomColor", pSunRaysCustomColor);
+	p3DEngine->SetPostEffectParamByHandle(s_sunShaftsActiveParam.Get(), (fSunShaftsVis > 0.05f || fSunRaysVis > 0.05f) ? 1.f : 0.f);
+	p3DEngine->SetPostEffectParamByHandle(s_sunShaftsAmountParam.Get(), fSunShaftsVis);
+	p3DEngine->SetPostEffectParamByHandle(s_sunShaftsRaysAmountParam.Get(), fSunRaysVis);
+	p3DEngine->SetPostEffectParamByHandle(s_sunShaftsRaysAttenuationParam.Get(), fSunRaysAtten);
+	p3DEngine->SetPostEffectParamByHandle(s_sunShaftsRaysSunColInfluenceParam.Get(), fSunRaySunColInfluence);
+	p3DEngine->SetPostEffectParamVec4ByHandle(s_sunShaftsRaysCustomColorParam.Get(), pSunRaysCustomColor);
 
 	{
 		const Vec3 cloudShadingMultipliers = Vec3(GetValue(PARAM_CLOUDSHADING_SUNLIGHT_MULTIPLIER).x, GetValue(PARAM_CLOUDSHADING_SKYLIGHT_MULTIPLIER).x, 0);
@@ -1351,10 +1660,10 @@ void CTimeOfDay::UpdateEnvLighting(bool forceUpdate)
 	p3DEngine->SetGlobalParameter(E3DPARAM_COLORGRADING_FILTERS_PHOTOFILTER_DENSITY, Vec3(fValue, 0, 0));
 
 	fValue = GetValue(PARAM_COLORGRADING_DOF_FOCUSRANGE).x;
-	p3DEngine->SetPostEffectParam("Dof_Tod_FocusRange", fValue);
+	p3DEngine->SetPostEffectParamByHandle(s_dofFocusRangeParam.Get(), fValue);
 
 	fValue = GetValue(PARAM_COLORGRADING_DOF_BLURAMOUNT).x;
-	p3DEngine->SetPostEffectParam("Dof_Tod_BlurAmount", fValue);
+	p3DEngine->SetPostEffectParamByHandle(s_dofBlurAmountParam.Get(), fValue);
 
 	const float arrDepthConstBias[MAX_SHADOW_CASCADES_NUM] =
 	{
@@ -1668,9 +1977,77 @@ void CTimeOfDay::Tick()
 					fTime = m_advancedInfo.fStartTime;
 			}
 
-			SetTime(fTime);
+			if (e_TimeOfDayUpdateRate > 0.0f || e_TimeOfDayUpdateMinDelta > 0.0f)
+			{
+				TickDecoupled(fTime);
+			}
+			else
+			{
+				SetTime(fTime);
+			}
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CTimeOfDay::TickDecoupled(float fTime)
+{
+	CRY_PROFILE_FUNCTION(PROFILE_3DENGINE);
+
+	m_fTime = fTime;
+	Cry3DEngineBase::GetCVars()->e_TimeOfDay = m_fTime;
+
+	SDecoupledUpdateState& state = s_decoupledUpdate;
+	CEnvironmentPreset& preset = GetPreset();
+
+	const float fSpan = state.nextTime - state.prevTime;
+	float fAlpha = (fSpan != 0.0f) ? GetWrappedHourDelta(state.prevTime, m_fTime) / fSpan : 1.0f;
+
+	if (!state.bValid || fAlpha < 0.0f || fAlpha >= 1.0f)
+	{
+		// Look ahead by the game time that passes until the next evaluation
+		const float fInterval = (e_TimeOfDayUpdateRate > 0.0f) ? 1.0f / e_TimeOfDayUpdateRate : 0.0f;
+		const float fLookAhead = max(fabs_tpl(m_advancedInfo.fAnimSpeed) * fInterval, e_TimeOfDayUpdateMinDelta);
+
+		// Time that went past the last target, jumps or advances beyond a look-ahead
+		// must not continue from it or the lighting would only crawl after the time
+		const float fPastNext = GetWrappedHourDelta(state.nextTime, m_fTime) * (fSpan < 0.0f ? -1.0f : 1.0f);
+
+		if (state.bValid && fAlpha >= 1.0f && fPastNext >= 0.0f && fPastNext < fLookAhead)
+		{
+			// continue from the last evaluation, only the new target needs the splines
+			memcpy(state.prevValues, state.nextValues, sizeof(state.prevValues));
+			state.prevTime = fmod_tpl(state.nextTime, 24.0f);
 		}
+		else
+		{
+			EvaluatePresetAt(preset, m_fTime, state.prevValues);
+			state.prevTime = m_fTime;
+		}
+
+		state.nextTime = state.prevTime + fsgnf(m_advancedInfo.fAnimSpeed) * fLookAhead;
+		EvaluatePresetAt(preset, state.nextTime, state.nextValues);
+		state.bValid = true;
+
+		const float fNewSpan = state.nextTime - state.prevTime;
+		fAlpha = (fNewSpan != 0.0f) ? GetWrappedHourDelta(state.prevTime, m_fTime) / fNewSpan : 1.0f;
+
+		// Audio and listeners only need to follow the evaluation rate
+		if (m_timeOfDayRtpcId != CryAudio::InvalidControlId)
+		{
+			gEnv->pAudioSystem->SetParameterGlobally(m_timeOfDayRtpcId, m_fTime);
+		}
+
+		gEnv->pSystem->GetISystemEventDispatcher()->OnSystemEvent(ESYSTEM_EVENT_TIME_OF_DAY_SET, 0, 0);
 	}
+
+	fAlpha = clamp_tpl(fAlpha, 0.0f, 1.0f);
+	for (int i = 0; i < PARAM_TOTAL; ++i)
+	{
+		preset.GetVar(static_cast<ETimeOfDayParamID>(i))->SetValue(Lerp(state.prevValues[i], state.nextValues[i], fAlpha));
+	}
+
+	UpdateEnvLighting(false);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -4,6 +4,7 @@
 #include "TimeOfDayConstants.h"
 
 #include <CrySerialization/IArchive.h>
+#include <CrySerialization/IArchiveHost.h>
 #include <CrySerialization/Decorators/Range.h>
 #include <CrySerialization/Decorators/Resources.h>
 
@@ -30,6 +31,27 @@ void SerializeSvoTi(Serialization::IArchive& ar, T& val, const char* name, const
 	ar(val, name, userName);
 	AddHelp(ar, name, prefix);
 }
+
+// Serializes one category and flags it as changed when an input archive modified its values
+template<typename T>
+void SerializeCategory(Serialization::IArchive& ar, T& category, const char* name, const char* label, uint32 categoryFlag, uint32& changedCategories)
+{
+	if (!ar.isInput())
+	{
+		ar(category, name, label);
+		return;
+	}
+
+	DynArray<char> before, after;
+	Serialization::SaveBinaryBuffer(before, category);
+	ar(category, name, label);
+	Serialization::SaveBinaryBuffer(after, category);
+
+	if (before.size() != after.size() || memcmp(before.data(), after.data(), before.size()) != 0)
+	{
+		changedCategories |= categoryFlag;
+	}
+}
 } // unnamed namespace
 
 //////////////////////////////////////////////////////////////////////////
@@ -344,6 +366,7 @@ void TotalIllumAdvImpl::Serialize(Serialization::IArchive& ar)
 
 //////////////////////////////////////////////////////////////////////////
 STimeOfDayConstants::STimeOfDayConstants()
+	: m_changedCategories(0)
 {
 	Reset();
 }
@@ -359,19 +382,29 @@ void STimeOfDayConstants::Reset()
 	totalIllumination.ResetVariables();
 	totalIlluminationAdvanced.ResetVariables();
 	imageSettings.ResetVariables();
+
+	MarkChanged(ITimeOfDay::CONSTANTS_ALL);
 }
 
 void STimeOfDayConstants::Serialize(Serialization::IArchive& ar)
 {
-	ar(sun, "Sun", "Sun");
-	ar(moon, "Moon", "Moon");
-	ar(sky, "Sky", "Skybox");
-	ar(wind, "Wind", "Wind");
-	ar(cloudShadows, "CloudShadows", "Cloud Shadows");
+	SerializeCategory(ar, sun, "Sun", "Sun", ITimeOfDay::CONSTANTS_SUN, m_changedCategories);
+	SerializeCategory(ar, moon, "Moon", "Moon", ITimeOfDay::CONSTANTS_MOON, m_changedCategories);
+	SerializeCategory(ar, sky, "Sky", "Skybox", ITimeOfDay::CONSTANTS_SKY, m_changedCategories);
+	SerializeCategory(ar, wind, "Wind", "Wind", ITimeOfDay::CONSTANTS_WIND, m_changedCategories);
+	SerializeCategory(ar, cloudShadows, "CloudShadows", "Cloud Shadows", ITimeOfDay::CONSTANTS_CLOUD_SHADOWS, m_changedCategories);
+	// Image settings are pushed to their cvars while serializing and have no further dependent state
 	ar(imageSettings, "ImageSettings", "Image Settings");
-	ar(colorGrading, "ColorGrading", "Color Grading");
-	ar(totalIllumination, "TotalIllumination", "Total Illumination");
-	ar(totalIlluminationAdvanced, "TotalIlluminationAdv", "Total Illumination Advanced");
+	SerializeCategory(ar, colorGrading, "ColorGrading", "Color Grading", ITimeOfDay::CONSTANTS_COLOR_GRADING, m_changedCategories);
+	SerializeCategory(ar, totalIllumination, "TotalIllumination", "Total Illumination", ITimeOfDay::CONSTANTS_TOTAL_ILLUMINATION, m_changedCategories);
+	SerializeCategory(ar, totalIlluminationAdvanced, "TotalIlluminationAdv", "Total Illumination Advanced", ITimeOfDay::CONSTANTS_TOTAL_ILLUMINATION, m_changedCategories);
+}
+
+uint32 STimeOfDayConstants::ConsumeChangedCategories(uint32 mask)
+{
+	const uint32 categories = m_changedCategories & mask;
+	m_changedCategories &= ~mask;
+	return categories;
 }
 
 ITimeOfDay::Sun& STimeOfDayConstants::GetSunParams()
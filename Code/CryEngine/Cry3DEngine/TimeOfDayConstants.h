@@ -85,6 +85,11 @@ struct STimeOfDayConstants : public ITimeOfDay::IConstants
 	virtual void Serialize(Serialization::IArchive& ar) override;
 	virtual void Reset() override;
 
+	//! Adds ITimeOfDay::CONSTANTS_* categories to be re-applied by the next CTimeOfDay::ConstantsChanged()
+	void   MarkChanged(uint32 categories) { m_changedCategories |= categories; }
+	//! Returns and clears the categories of the mask changed since they were last consumed
+	uint32 ConsumeChangedCategories(uint32 mask = ~0u);
+
 	SunImpl           sun;
 	MoonImpl          moon;
 	SkyImpl           sky;
@@ -94,4 +99,7 @@ struct STimeOfDayConstants : public ITimeOfDay::IConstants
 	TotalIllumImpl    totalIllumination;
 	TotalIllumAdvImpl totalIlluminationAdvanced;
 	ImageSettingsImpl imageSettings;
+
+private:
+	uint32            m_changedCategories;
 };
@@ -365,6 +365,8 @@ struct ITimeOfDay
 		virtual bool GetSplineKeysForVar(int nIndex, int nSpline, SBezierKey* keysArray, unsigned int keysArraySize) const = 0;
 		virtual bool SetSplineKeysForVar(int nIndex, int nSpline, const SBezierKey* keysArray, unsigned int keysArraySize) = 0;
 		virtual bool UpdateSplineKeyForVar(int nIndex, int nSpline, float fTime, float newValue) = 0;
+		//! Batched version of UpdateSplineKeyForVar, derived spline data is rebuilt once for all keys.
+		virtual bool UpdateSplineKeysForVar(int nIndex, int nSpline, const float* pTimes, const float* pNewValues, unsigned int nCount) = 0;
 
 		virtual void Reset() = 0;
 	};
@@ -477,9 +479,23 @@ struct ITimeOfDay
 	//! Updates engine parameters after variable values have been changed.
 	virtual void Update(bool bInterpolate = true, bool bForceUpdate = false) = 0;
 
-	//! Updates engine parameters after constant values have been changed
+	//! Categories of preset constants, used to limit the engine state updated by ConstantsChanged(uint32).
+	static const uint32 CONSTANTS_SUN = BIT(0);
+	static const uint32 CONSTANTS_MOON = BIT(1);
+	static const uint32 CONSTANTS_SKY = BIT(2);
+	static const uint32 CONSTANTS_WIND = BIT(3);
+	static const uint32 CONSTANTS_CLOUD_SHADOWS = BIT(4);
+	static const uint32 CONSTANTS_COLOR_GRADING = BIT(5);
+	static const uint32 CONSTANTS_TOTAL_ILLUMINATION = BIT(6);
+	static const uint32 CONSTANTS_ALL = BIT(7) - 1;
+
+	//! Updates engine parameters after constant values have been changed.
+	//! Only categories changed through IConstants::Serialize are updated; otherwise all constants are assumed changed.
 	virtual void ConstantsChanged() = 0;
 
+	//! Updates only the engine parameters depending on the given CONSTANTS_* categories.
+	virtual void ConstantsChanged(uint32 categories) = 0;
+
 	virtual void BeginEditMode() = 0;
 	virtual void EndEditMode() = 0;
 
@@ -436,7 +436,12 @@ int CPostEffectsMgr::Init()
 	StringEffectMapItor pItor = m_pNameIdMapGen.begin(), pEnd = m_pNameIdMapGen.end();
 	for (; pItor != pEnd; ++pItor)
 	{
-		m_pNameIdMap.insert(KeyEffectMapItor::value_type(GetCRC(pItor->first.c_str()), pItor->second));
+		const uint32 nKey = GetCRC(pItor->first.c_str());
+		if (m_pNameIdMap.insert(KeyEffectMapItor::value_type(nKey, pItor->second)).second)
+		{
+			m_pNameHandleMap.insert(KeyHandleMapItor::value_type(nKey, (int32)m_paramHandles.size()));
+			m_paramHandles.push_back({ pItor->second, pItor->first });
+		}
 	}
 
 	m_pNameIdMapGen.clear();
@@ -497,6 +502,8 @@ void CPostEffectsMgr::Release()
 
 	std::for_each(m_pNameIdMap.begin(), m_pNameIdMap.end(), SContainerKeyEffectParamDelete());
 	m_pNameIdMap.clear();
+	m_pNameHandleMap.clear();
+	m_paramHandles.clear();
 
 	std::for_each(m_pEffects.begin(), m_pEffects.end(), container_object_safe_release());
 	std::for_each(m_pEffects.begin(), m_pEffects.end(), container_object_safe_delete());
@@ -660,6 +667,34 @@ CEffectParam* CPostEffectsMgr::GetByName(const char* pszParam)
 	return 0;
 }
 
+int32 CPostEffectsMgr::GetParamHandle(const char* pszParam)
+{
+	CRY_ASSERT(pszParam, "GetParamHandle: null FX name");
+
+	KeyHandleMapItor pItor = m_pNameHandleMap.find(GetCRC(pszParam));
+	if (pItor != m_pNameHandleMap.end())
+	{
+		return pItor->second;
+	}
+
+	return -1;
+}
+
+CEffectParam* CPostEffectsMgr::GetByHandle(int32 nHandle)
+{
+	if (nHandle < 0 || nHandle >= (int32)m_paramHandles.size())
+	{
+		return 0;
+	}
+
+	const SParamHandleEntry& entry = m_paramHandles[nHandle];
+
+	if (CRenderer::CV_r_PostProcess == 3)
+		m_pEffectParamsUpdated.insert(StringEffectMapItor::value_type(entry.name, entry.pParam));
+
+	return entry.pParam;
+}
+
 float CPostEffectsMgr::GetByNameF(const char* pszParam)
 {
 	CEffectParam* pParam = GetByName(pszParam);
@@ -400,6 +400,9 @@ typedef StringEffectMap::iterator       StringEffectMapItor;
 typedef std::map<uint32, CEffectParam*> KeyEffectMap;
 typedef KeyEffectMap::iterator          KeyEffectMapItor;
 
+typedef std::map<uint32, int32>         KeyHandleMap;
+typedef KeyHandleMap::iterator          KeyHandleMapItor;
+
 typedef std::vector<CPostEffect*>       CPostEffectVec;
 typedef CPostEffectVec::iterator        CPostEffectItor;
 
@@ -517,6 +520,13 @@ public:
 	float GetByNameF(const char* pszParam);
 	Vec4  GetByNameVec4(const char* pszParam);
 
+	// Resolve a parameter name once into a handle for GetByHandle, returns -1 if parameter doesn't exist
+	// Note: handles stay valid for the lifetime of the manager, callers should resolve them once and keep them
+	int32         GetParamHandle(const char* pszParam);
+
+	// Given a handle returned by GetParamHandle returns corresponding CEffectParam, else returns null
+	CEffectParam* GetByHandle(int32 nHandle);
+
 	// Register effect
 	void RegisterEffect(CPostEffect* pEffect)
 	{
@@ -614,6 +624,15 @@ protected:
 	CPostEffectVec      m_activeEffects[RT_COMMAND_BUF_COUNT];
 	KeyEffectMap        m_pNameIdMap;
 	StringEffectMap     m_pNameIdMapGen;
+
+	// handle based access, indexed by handles returned from GetParamHandle
+	struct SParamHandleEntry
+	{
+		CEffectParam* pParam;
+		string        name;
+	};
+	std::vector<SParamHandleEntry> m_paramHandles;
+	KeyHandleMap                   m_pNameHandleMap;
 	// for debugging purposes only
 	StringEffectMap     m_pEffectParamsUpdated;
 #ifndef _RELEASE
@@ -4563,6 +4563,66 @@ void CRenderer::EF_GetPostEffectParamString(const char* pParam, const char*& psz
 	pszArg = pEffectParam->GetParamString();
 }
 
+//////////////////////////////////////////////////////////////////////////
+int32 CRenderer::EF_GetPostEffectParamHandle(const char* pParam)
+{
+	CRY_ASSERT((pParam), "mfGetParameterHandle: null parameter");
+	if (!pParam)
+	{
+		return -1;
+	}
+
+	return PostEffectMgr()->GetParamHandle(pParam);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CRenderer::EF_SetPostEffectParamByHandle(int32 nHandle, float fValue, bool bForceValue)
+{
+	CEffectParam* pEffectParam = PostEffectMgr()->GetByHandle(nHandle);
+	if (!pEffectParam)
+	{
+		return;
+	}
+
+	pEffectParam->SetParam(fValue, bForceValue);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CRenderer::EF_SetPostEffectParamVec4ByHandle(int32 nHandle, const Vec4& pValue, bool bForceValue)
+{
+	CEffectParam* pEffectParam = PostEffectMgr()->GetByHandle(nHandle);
+	if (!pEffectParam)
+	{
+		return;
+	}
+
+	pEffectParam->SetParamVec4(pValue, bForceValue);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CRenderer::EF_GetPostEffectParamByHandle(int32 nHandle, float& fValue)
+{
+	CEffectParam* pEffectParam = PostEffectMgr()->GetByHandle(nHandle);
+	if (!pEffectParam)
+	{
+		return;
+	}
+
+	fValue = pEffectParam->GetParam();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CRenderer::EF_GetPostEffectParamVec4ByHandle(int32 nHandle, Vec4& pValue)
+{
+	CEffectParam* pEffectParam = PostEffectMgr()->GetByHandle(nHandle);
+	if (!pEffectParam)
+	{
+		return;
+	}
+
+	pValue = pEffectParam->GetParamVec4();
+}
+
 //////////////////////////////////////////////////////////////////////////
 int32 CRenderer::EF_GetPostEffectID(const char* pPostEffectName)
 {